@@ -0,0 +1,234 @@
+#include "field.h"
+#include "hash_life_field.h"
+#include "thread_pool.h"
+#include "simd.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+ * Замер скорости симуляции без окна.
+ * Каждый повтор заново заполняет поле из seed, прогревает его и замеряет generations поколений
+ */
+int main(int argc, const char* args[]) {
+    using namespace lifegame;
+    using std::cout;
+    using std::cerr;
+    using std::endl;
+    using std::exception;
+    using std::string;
+    using std::vector;
+    using std::sort;
+    using std::sqrt;
+
+    using clock = std::chrono::steady_clock;
+
+    string fieldType = "cell", rulesName = "B3/S23", zoneName = "quad";
+    int width = 1920, height = 1080;
+    unsigned seed = 1, threadsCount = 0;
+    int warmup = 100, generations = 1000, repeats = 5, batch = 1;
+    double density = 0.5;
+    Topology topology = TOPOLOGY_PLANE;
+    bool json = false;
+
+    for(int i = 1; i < argc; ++i) {
+        const string arg = args[i];
+
+        if((arg == "-f" || arg == "--field") && i + 1 < argc) {
+            fieldType = args[++i];
+
+        } else if(arg == "--size" && i + 1 < argc) {
+            if(sscanf(args[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                cerr << "Invalid size \"" << args[i] << "\"" << endl;
+                return 1;
+            }
+
+        } else if(arg == "--rules" && i + 1 < argc) {
+            rulesName = args[++i];
+
+        } else if(arg == "--zone" && i + 1 < argc) {
+            zoneName = args[++i];
+
+        } else if(arg == "--seed" && i + 1 < argc) {
+            seed = atoi(args[++i]);
+
+        } else if(arg == "--density" && i + 1 < argc) {
+            density = atof(args[++i]);
+
+        } else if((arg == "-g" || arg == "--generations") && i + 1 < argc) {
+            generations = atoi(args[++i]);
+
+        } else if(arg == "--warmup" && i + 1 < argc) {
+            warmup = atoi(args[++i]);
+
+        } else if(arg == "--repeats" && i + 1 < argc) {
+            repeats = std::max(atoi(args[++i]), 1);
+
+        } else if(arg == "--batch" && i + 1 < argc) {
+            batch = std::max(atoi(args[++i]), 1);
+
+        } else if((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            threadsCount = atoi(args[++i]);
+
+        } else if(arg == "--memory" && i + 1 < argc) {
+            HashLifeField::defaultMemoryLimit = (size_t)atol(args[++i]) << 20;
+
+        } else if(arg == "--simd" && i + 1 < argc) {
+            const string level = args[++i];
+            int index = 0;
+
+            while(index < SIMD_LEVELS && level != SIMD_LEVEL_NAMES[index])
+                ++index;
+
+            if(index == SIMD_LEVELS) {
+                cerr << "Unknown SIMD level \"" << level << "\"" << endl;
+                return 1;
+            }
+
+            setSimdLevel((SimdLevel)index);
+
+        } else if(arg == "--topology" && i + 1 < argc) {
+            const string name = args[++i];
+            int index = 0;
+
+            while(index < TOPOLOGIES && name != TOPOLOGY_NAMES[index])
+                ++index;
+
+            if(index == TOPOLOGIES) {
+                cerr << "Unknown topology \"" << name << "\"" << endl;
+                return 1;
+            }
+
+            topology = (Topology)index;
+
+        } else if(arg == "--json") {
+            json = true;
+
+        } else {
+            cerr << "Usage: " << args[0] << " [--field <type>] [--size <width>x<height>] [--rules <B3/S23>] [--zone <name>]" << endl
+                 << "       [--seed <n>] [--density <0..1>] [--generations <n>] [--warmup <n>] [--repeats <n>] [--batch <n>]" << endl
+                 << "       [--threads <count>] [--memory <MB>] [--simd <level>] [--topology <name>] [--json]" << endl;
+            return 1;
+        }
+    }
+
+    try {
+        const Rules rules = Rules::parse(rulesName);
+        const CheckZone* checkZone = nullptr;
+
+        for(const CheckZone* zone : CheckZone::checkZones) {
+            if(zone->name == zoneName)
+                checkZone = zone;
+        }
+
+        if(checkZone == nullptr) {
+            cerr << "Unknown check zone \"" << zoneName << "\"" << endl;
+            return 1;
+        }
+
+        ThreadPool threadPool(threadsCount);
+        vector<double> seconds;
+
+        // Участков, пересчитанных за вызов step() в измеряемых поколениях, и всего участков в последнем повторе
+        uint64_t activeTiles = 0, steps = 0;
+        int tilesCount = 0;
+
+        for(int repeat = 0; repeat < repeats; ++repeat) {
+            Field* field = Field::create(fieldType, width, height);
+            field->setThreadPool(&threadPool);
+            field->setTopology(topology);
+
+            std::mt19937 random(seed);
+            std::bernoulli_distribution alive(density);
+
+            for(int x = 0; x < width; ++x) {
+                for(int y = 0; y < height; ++y) {
+                    if(alive(random))
+                        field->set(x, y, true);
+                }
+            }
+
+            for(int done = 0; done < warmup; done += batch) {
+                field->step(rules, *checkZone, std::min(batch, warmup - done));
+            }
+
+            const clock::time_point start = clock::now();
+
+            for(int done = 0; done < generations; done += batch) {
+                field->step(rules, *checkZone, std::min(batch, generations - done));
+                activeTiles += field->getActiveTilesCount();
+                ++steps;
+            }
+
+            seconds.push_back(std::chrono::duration<double>(clock::now() - start).count());
+            tilesCount = field->getTilesCount();
+
+            if(!json)
+                cout << "repeat " << repeat + 1 << ": " << generations / seconds.back() << " gen/s" << endl;
+
+            delete field;
+        }
+
+        vector<double> rates;
+
+        for(double time : seconds)
+            rates.push_back(generations / time);
+
+        sort(rates.begin(), rates.end());
+
+        double mean = 0, variance = 0;
+
+        for(double rate : rates)
+            mean += rate;
+
+        mean /= rates.size();
+
+        for(double rate : rates)
+            variance += (rate - mean) * (rate - mean);
+
+        const double
+                median = rates[rates.size() / 2],
+                stddev = sqrt(variance / rates.size()),
+                cellUpdates = median * width * height,
+                nsPerCell = 1e9 / cellUpdates,
+                activeTilesMean = steps != 0 ? (double)activeTiles / steps : 0;
+
+        if(json) {
+            cout << "{\"field\": \"" << fieldType << "\", \"width\": " << width << ", \"height\": " << height
+                 << ", \"rules\": \"" << rulesName << "\", \"zone\": \"" << zoneName << "\", \"topology\": \"" << TOPOLOGY_NAMES[topology]
+                 << "\", \"seed\": " << seed << ", \"density\": " << density
+                 << ", \"threads\": " << threadPool.getThreadsCount() << ", \"simd\": \"" << SIMD_LEVEL_NAMES[getSimdLevel()]
+                 << "\", \"warmup\": " << warmup << ", \"generations\": " << generations << ", \"batch\": " << batch
+                 << ", \"repeats\": " << repeats << ", \"seconds\": [";
+
+            for(size_t i = 0; i < seconds.size(); ++i)
+                cout << (i == 0 ? "" : ", ") << seconds[i];
+
+            cout << "], \"gensPerSecond\": {\"median\": " << median << ", \"mean\": " << mean << ", \"min\": " << rates.front()
+                 << ", \"max\": " << rates.back() << ", \"stddev\": " << stddev << "}"
+                 << ", \"cellUpdatesPerSecond\": " << cellUpdates << ", \"nsPerCell\": " << nsPerCell
+                 << ", \"tiles\": " << tilesCount << ", \"activeTilesMean\": " << activeTilesMean << "}" << endl;
+
+        } else {
+            cout << fieldType << ' ' << width << 'x' << height << ", rules " << rules.name << ", zone " << zoneName
+                 << ", " << threadPool.getThreadsCount() << " threads, simd " << SIMD_LEVEL_NAMES[getSimdLevel()] << endl
+                 << "gen/s: median " << median << ", mean " << mean << ", min " << rates.front() << ", max " << rates.back()
+                 << ", stddev " << stddev << endl
+                 << "cell updates/s: " << cellUpdates << endl
+                 << "ns/cell: " << nsPerCell << endl;
+
+            if(tilesCount != 0)
+                cout << "active tiles per step: mean " << activeTilesMean << " of " << tilesCount << endl;
+        }
+
+    } catch(exception& ex) {
+        cerr << ex.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
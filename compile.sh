@@ -1,2 +1,4 @@
 #!/bin/sh
 g++ -std=c++17 -O3 main.cpp src/*.cpp -Iinclude/ -I/usr/include/SFML -L/usr/lib -lsfml-graphics -lsfml-window -lsfml-system -lpthread -o life-game
+g++ -std=c++17 -O3 benchmark.cpp src/*.cpp -Iinclude/ -I/usr/include/SFML -L/usr/lib -lsfml-graphics -lsfml-window -lsfml-system -lpthread -o life-game-benchmark
+g++ -std=c++17 -O3 micro_benchmark.cpp src/*.cpp -Iinclude/ -I/usr/include/SFML -L/usr/lib -lsfml-graphics -lsfml-window -lsfml-system -lpthread -o life-game-micro-benchmark
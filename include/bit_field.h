@@ -0,0 +1,90 @@
+#ifndef LIFEGAME_BIT_FIELD_H
+#define LIFEGAME_BIT_FIELD_H
+
+#include <cstdint>
+#include <vector>
+#include "field.h"
+
+namespace lifegame {
+
+    /**
+     * Поле, упакованное по 64 клетки в машинное слово.
+     * Каждый столбец хранится как массив слов, бит k слова i - клетка с y = 64 * i + k.
+     * Следующее поколение считается побитовыми сумматорами сразу для 64 клеток.
+     * Изменения отслеживаются участками WORD_BITS x WORD_BITS: WORD_BITS столбцов по одному слову
+     */
+    class BitField: public Field {
+        public:
+            typedef uint64_t word_t;
+
+            static const int WORD_BITS = 64;
+
+        protected:
+            int dataWidth, dataHeight;
+            int stride; // Слов на столбец, включая по одному пустому слову сверху и снизу
+            word_t *front, *back;
+
+            vector<char> untakenTiles; // Изменившиеся с прошлого takeChangedTiles(), индекс - tileX * wordsFor(height) + i
+
+            static int wordsFor(int height);
+
+            /** Отмечает все участки изменившимися */
+            void resetUntakenTiles();
+
+            inline word_t* column(word_t* buffer, int x) const {
+                return buffer + (x + 1) * stride + 1;
+            }
+
+            inline const word_t* column(const word_t* buffer, int x) const {
+                return buffer + (x + 1) * stride + 1;
+            }
+
+            /** Маска значащих бит в слове i столбца высотой height */
+            static word_t wordMask(int i, int height);
+
+        public:
+            BitField(int width, int height);
+            virtual ~BitField();
+
+            virtual bool get(int x, int y) const override;
+
+            virtual void set(int x, int y, bool on) override;
+
+            virtual void resize(int width, int height) override;
+
+            virtual bool supportsTopology(Topology) const override;
+
+            virtual void setTopology(Topology) override;
+
+            using Field::step;
+
+            virtual void step(const Rules&, const CheckZone&) override;
+
+            virtual void clear() override;
+
+            virtual void fill() override;
+
+            using Field::forEachOn;
+
+            virtual void forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const override;
+
+            virtual uint64_t hash() override;
+
+            virtual int getChangedTileSize() const override;
+
+            virtual bool takeChangedTiles(vector<Tile>& tiles) override;
+
+            virtual uint32_t countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const override;
+
+        protected:
+            void fillWith(bool on);
+
+            /** Очищает все биты за пределами поля, включая рамку вокруг него */
+            void clearOutside();
+
+            /** Заполняет рамку вокруг поля копиями противоположных краёв (для TOPOLOGY_TORUS и TOPOLOGY_KLEIN) */
+            void updateBorder();
+    };
+}
+
+#endif // LIFEGAME_BIT_FIELD_H
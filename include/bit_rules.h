@@ -0,0 +1,73 @@
+#ifndef LIFEGAME_BIT_RULES_H
+#define LIFEGAME_BIT_RULES_H
+
+#include <cstdint>
+#include "rules.h"
+#include "check_zone.h"
+
+namespace lifegame {
+
+    /**
+     * Правила и окрестность, подготовленные для вычисления следующего поколения
+     * сразу для 64 клеток столбца, упакованных в слово (бит k - клетка с y = k)
+     */
+    class BitRules {
+        public:
+            typedef uint64_t word_t;
+
+            static const int WORD_BITS = 64;
+
+        private:
+            int planes[8], planesCount = 0;
+
+            // Числа соседей, при которых клетка может оказаться живой
+            int counts[MAX_RULE_NUMS + 1], countsNumber = 0;
+            bool birth[MAX_RULE_NUMS + 1], survive[MAX_RULE_NUMS + 1];
+
+        public:
+            BitRules(const Rules&, const CheckZone&);
+
+            /**
+             * Следующее поколение слова words[1].
+             * Индекс массивов - dx + 1 (левый, текущий и правый столбец),
+             * above и below - соседние слова тех же столбцов сверху и снизу
+             */
+            inline word_t next(const word_t above[3], const word_t words[3], const word_t below[3]) const {
+                word_t neighbours[9];
+
+                for(int c = 0; c < 3; ++c) {
+                    neighbours[c * 3 + 0] = words[c] << 1 | above[c] >> (WORD_BITS - 1); // Сосед сверху (y - 1)
+                    neighbours[c * 3 + 1] = words[c];
+                    neighbours[c * 3 + 2] = words[c] >> 1 | below[c] << (WORD_BITS - 1); // Сосед снизу (y + 1)
+                }
+
+                // Четырёхбитный счётчик соседей для 64 клеток сразу
+                word_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+                for(int p = 0; p < planesCount; ++p) {
+                    word_t carry = neighbours[planes[p]], t;
+                    t = s0 & carry; s0 ^= carry; carry = t;
+                    t = s1 & carry; s1 ^= carry; carry = t;
+                    t = s2 & carry; s2 ^= carry; carry = t;
+                    s3 |= carry;
+                }
+
+                word_t born = 0, survived = 0;
+
+                for(int c = 0; c < countsNumber; ++c) {
+                    const int n = counts[c];
+                    const word_t count =
+                            (n & 1 ? s0 : ~s0) & (n & 2 ? s1 : ~s1) &
+                            (n & 4 ? s2 : ~s2) & (n & 8 ? s3 : ~s3);
+
+                    if(birth[n]) born |= count;
+                    if(survive[n]) survived |= count;
+                }
+
+                const word_t cells = words[1];
+                return (cells & survived) | (~cells & born);
+            }
+    };
+}
+
+#endif // LIFEGAME_BIT_RULES_H
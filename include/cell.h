@@ -3,22 +3,13 @@
 
 #include <SFML/Graphics.hpp>
 
-#ifdef DRAW_PARALLEL
-#include <mutex>
-#endif // DRAW_PARALLEL
-
 namespace lifegame {
 
     using namespace sf;
 
-    #ifdef DRAW_PARALLEL
-    using std::mutex;
-    #endif // DRAW_PARALLEL
-
 	static const char
 			CELL_ON = 0x1,
-			CELL_OFF = 0x0,
-			CELL_WILL_CHANGE = 0x2;
+			CELL_OFF = 0x0;
 
     static const int
             MIN_CELL_SIZE = 4,
@@ -52,27 +43,11 @@ namespace lifegame {
                 value = CELL_OFF;
             }
 
-            inline void setWillChange() {
-                value |= CELL_WILL_CHANGE;
-            }
-
-            inline bool willChange() const {
-                return (value & CELL_WILL_CHANGE) != 0;
-            }
-
-            inline void change() {
-                value = (value ^ CELL_ON) & CELL_ON;
-            }
-
-            void draw(RenderWindow&, int x, int y) const;
-
-            static void drawCell(RenderWindow&, int x, int y);
+            void draw(RenderTarget&, int x, int y) const;
 
-            #ifdef DRAW_PARALLEL
-            static void drawCellSynchronized(RenderWindow&, int x, int y, mutex& mtx);
-            #endif // DRAW_PARALLEL
+            static void drawCell(RenderTarget&, int x, int y);
 
-            bool intersectsWith(Vector2i startPoint, Vector2i endPoint, int x, int y) const;
+            static bool intersectsWith(Vector2i startPoint, Vector2i endPoint, int x, int y);
 
         protected:
             static int sign(Vector2i startPoint, Vector2i endPoint, int x, int y);
@@ -0,0 +1,138 @@
+#ifndef LIFEGAME_CELL_FIELD_H
+#define LIFEGAME_CELL_FIELD_H
+
+#include <vector>
+#include <cstdint>
+#include "field.h"
+#include "cell.h"
+#include "cell_grid.h"
+#include "util.h"
+#include "step_kernel.h"
+
+namespace lifegame {
+
+    /**
+     * Поле, хранящее каждую клетку в отдельном байте (Cell).
+     * Эталонная реализация, с которой сравниваются остальные.
+     * Поле разбито на участки TILE_SIZE x TILE_SIZE, пересчитываются только те,
+     * в которых или в соседях которых что-то изменилось на прошлом шаге.
+     * Следующее поколение записывается в отдельный буфер, после чего буферы меняются местами.
+     * Несколько поколений подряд считаются блоками: каждый участок вместе с рамкой шириной в число поколений
+     * копируется в небольшой буфер, который помещается в кеш, и продвигается на весь блок сразу
+     */
+    class CellField: public Field {
+        public:
+            static const int TILE_SIZE = MAX_KERNEL_HEIGHT;
+
+            /** Наибольшее число поколений, вычисляемых для участка за один проход */
+            static const int MAX_BLOCK_GENERATIONS = 4;
+
+            /** Поля меньше этого числа клеток обычно помещаются в кеш, и блоки лишь добавляют работу на рамках */
+            static const int64_t BLOCK_MIN_CELLS = 1 << 24;
+
+        protected:
+            int dataWidth, dataHeight;
+            CellGrid data;     // Текущее поколение
+            CellGrid nextData; // Следующее поколение
+
+            int tilesWidth = 0, tilesHeight = 0;
+            vector<char> changedTiles, activeTiles; // Индекс участка - tileX * tilesHeight + tileY
+            int activeTilesCount = 0;
+
+            // Хеши участков для hash(); пересчитываются только у изменившихся с прошлого вызова
+            vector<uint64_t> tileHashes;
+            vector<char> dirtyHashes;
+
+            vector<char> untakenTiles; // Изменившиеся с прошлого takeChangedTiles()
+
+            // Правила прошлого шага: при их смене пересчитывается всё поле и выбирается новое ядро
+            const Rules* lastRules = nullptr;
+            const CheckZone* lastCheckZone = nullptr;
+
+            StepKernel kernel = nullptr;
+            SimdLevel kernelSimdLevel = SIMD_NONE;
+
+            // Изменения участков отмечаются относительно блока из lastBlockGenerations поколений
+            int lastBlockGenerations = 1;
+
+        public:
+            CellField(int width, int height);
+            virtual ~CellField();
+
+            virtual bool get(int x, int y) const override;
+
+            virtual void set(int x, int y, bool on) override;
+
+            virtual void resize(int width, int height) override;
+
+            virtual bool supportsTopology(Topology) const override;
+
+            virtual void setTopology(Topology) override;
+
+            virtual void step(const Rules&, const CheckZone&) override;
+
+            virtual void step(const Rules&, const CheckZone&, int generations) override;
+
+            virtual void fillRandom() override;
+
+            virtual void clear() override;
+
+            virtual void fill() override;
+
+            using Field::forEachOn;
+
+            virtual void forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const override;
+
+            virtual uint64_t hash() override;
+
+            virtual int getActiveTilesCount() const override;
+
+            virtual int getTilesCount() const override;
+
+            virtual int getChangedTileSize() const override;
+
+            virtual bool takeChangedTiles(vector<Tile>& tiles) override;
+
+            virtual uint32_t countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const override;
+
+        protected:
+            void resetTiles();
+
+            inline void markChanged(int x, int y) {
+                const int tile = x / TILE_SIZE * tilesHeight + y / TILE_SIZE;
+                changedTiles[tile] = true;
+                dirtyHashes[tile] = true;
+                untakenTiles[tile] = true;
+            }
+
+            uint64_t hashTile(int tileX, int tileY) const;
+
+            /** Записывает участок следующего поколения в nextData и возвращает, изменился ли он */
+            bool stepTile(int tileX, int tileY, const Rules&, const CheckZone&);
+
+            /**
+             * То же, что stepTile, но сразу на generations поколений. front и back - рабочие буферы
+             * размером не меньше TILE_SIZE + 2 * generations
+             */
+            bool stepTileBlock(int tileX, int tileY, int generations, const Rules&, const CheckZone&, CellGrid& front, CellGrid& back);
+
+            /** Вычисляет блок из generations поколений для всех изменившихся участков */
+            void stepBlock(const Rules&, const CheckZone&, int generations);
+
+            void copyData(const CellGrid& from, CellGrid& to) const;
+
+            void extendDataIfNecessary();
+
+            void forEachCell(function<void(int, int, Cell&)>);
+
+            void forEachCell(int x, int y, int endX, int endY, function<void(int, int, Cell&)>);
+
+            /** Очищает всё за пределами поля, включая рамку вокруг него */
+            void clearOutside();
+
+            /** Заполняет рамку вокруг поля копиями противоположных краёв (для TOPOLOGY_TORUS и TOPOLOGY_KLEIN) */
+            void updateBorder();
+    };
+}
+
+#endif // LIFEGAME_CELL_FIELD_H
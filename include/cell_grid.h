@@ -0,0 +1,55 @@
+#ifndef LIFEGAME_CELL_GRID_H
+#define LIFEGAME_CELL_GRID_H
+
+#include <cstddef>
+#include "cell.h"
+
+namespace lifegame {
+
+    using std::ptrdiff_t;
+
+    /**
+     * Двумерный массив клеток с рамкой в 1 клетку вокруг, хранящийся одним блоком.
+     * Столбцы лежат подряд с шагом stride, адрес столбца вычисляется без таблицы указателей
+     */
+    class CellGrid {
+        private:
+            int width, height;
+            ptrdiff_t stride;
+            Cell* memory;
+            Cell* origin; // Клетка (0, 0)
+
+            void free();
+
+        public:
+            CellGrid(int width, int height);
+            ~CellGrid();
+
+            CellGrid(const CellGrid&) = delete;
+            CellGrid& operator=(const CellGrid&) = delete;
+
+            CellGrid(CellGrid&&);
+            CellGrid& operator=(CellGrid&&);
+
+            void swap(CellGrid&);
+
+            inline int getWidth() const {
+                return width;
+            }
+
+            inline int getHeight() const {
+                return height;
+            }
+
+            /** Столбец x, допустимые индексы от -1 до height включительно. x от -1 до width включительно */
+            inline Cell* operator[](int x) {
+                return origin + x * stride;
+            }
+
+            inline const Cell* operator[](int x) const {
+                return origin + x * stride;
+            }
+    };
+}
+
+#endif // LIFEGAME_CELL_GRID_H
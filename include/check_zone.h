@@ -2,13 +2,28 @@
 #define LIFEGAME_CHECK_ZONE_H
 
 #include <string>
+#include <cstdint>
 #include "cell.h"
+#include "simd.h"
 
 namespace lifegame {
 
     using std::string;
     using std::vector;
 
+    /** Считает соседей для count клеток столбца подряд и записывает в counts */
+    typedef void (*ColumnCounter)(const Cell* prevRow, const Cell* currRow, const Cell* nextRow, uint8_t* counts, int count);
+
+    constexpr int neighbourBit(int dx, int dy) {
+        return 1 << ((dx + 1) * 3 + (dy + 1));
+    }
+
+    /**
+     * Возвращает реализацию подсчёта соседей для окрестности и набора инструкций
+     * или nullptr, если для окрестности нет специализированной реализации
+     */
+    ColumnCounter columnCounterFor(int neighbourhood, SimdLevel);
+
     class CheckZone {
         public:
             static const CheckZone &QUAD, &RHOMB, &CROSS;
@@ -16,31 +31,62 @@ namespace lifegame {
 
             const string name;
 
-            CheckZone(string name):
-                    name(name) {}
+            /**
+             * Маска соседей в окрестности 3x3: бит (dx + 1) * 3 + (dy + 1)
+             * установлен, если клетка со смещением (dx, dy) считается соседом.
+             * Используется движками, которые не вызывают countNeighbours
+             */
+            const int neighbourhood;
+
+        private:
+            ColumnCounter columnCounters[SIMD_LEVELS];
+
+        public:
+            CheckZone(string name, int neighbourhood);
 
             virtual ~CheckZone() {}
 
+            inline bool includes(int dx, int dy) const {
+                return (neighbourhood & neighbourBit(dx, dy)) != 0;
+            }
+
             virtual int countNeighbours(Cell* prevRow, Cell* currRow, Cell* nextRow) const = 0;
+
+            /** То же, что countNeighbours, но сразу для count клеток столбца, с использованием SIMD */
+            void countColumn(Cell* prevRow, Cell* currRow, Cell* nextRow, uint8_t* counts, int count) const;
     };
 
     class QuadCheckZone: public CheckZone {
         public:
-            QuadCheckZone(): CheckZone("quad") {}
+            static constexpr int NEIGHBOURHOOD =
+                    neighbourBit(-1, -1) | neighbourBit(-1, 0) | neighbourBit(-1, 1) |
+                    neighbourBit( 0, -1) |                       neighbourBit( 0, 1) |
+                    neighbourBit( 1, -1) | neighbourBit( 1, 0) | neighbourBit( 1, 1);
+
+            QuadCheckZone(): CheckZone("quad", NEIGHBOURHOOD) {}
 
             virtual int countNeighbours(Cell* prevRow, Cell* currRow, Cell* nextRow) const override;
     };
 
     class RhombCheckZone: public CheckZone {
         public:
-            RhombCheckZone(): CheckZone("rhomb") {}
+            static constexpr int NEIGHBOURHOOD =
+                                           neighbourBit(-1, 0) |
+                    neighbourBit( 0, -1) |                       neighbourBit( 0, 1) |
+                                           neighbourBit( 1, 0);
+
+            RhombCheckZone(): CheckZone("rhomb", NEIGHBOURHOOD) {}
 
             virtual int countNeighbours(Cell* prevRow, Cell* currRow, Cell* nextRow) const override;
     };
 
     class CrossCheckZone: public CheckZone {
         public:
-            CrossCheckZone(): CheckZone("cross") {}
+            static constexpr int NEIGHBOURHOOD =
+                    neighbourBit(-1, -1) | neighbourBit(-1, 1) |
+                    neighbourBit( 1, -1) | neighbourBit( 1, 1);
+
+            CrossCheckZone(): CheckZone("cross", NEIGHBOURHOOD) {}
 
             virtual int countNeighbours(Cell* prevRow, Cell* currRow, Cell* nextRow) const override;
     };
@@ -0,0 +1,119 @@
+#ifndef LIFEGAME_CHUNK_FIELD_H
+#define LIFEGAME_CHUNK_FIELD_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "field.h"
+#include "bit_rules.h"
+
+namespace lifegame {
+
+    using std::unordered_map;
+    using std::unordered_set;
+    using std::vector;
+
+    /**
+     * Неограниченная вселенная, хранящаяся как хеш-таблица участков CHUNK_SIZE x CHUNK_SIZE.
+     * Участки создаются по мере распространения узора и удаляются, когда становятся пустыми,
+     * поэтому память и время шага пропорциональны заселённой площади.
+     * width и height задают лишь видимую область. Правила с рождением при 0 соседей не поддерживаются
+     */
+    class ChunkField: public Field {
+        public:
+            typedef BitRules::word_t word_t;
+
+            static constexpr int CHUNK_SIZE = BitRules::WORD_BITS;
+
+        protected:
+            /** Столбец участка упакован в слово: бит k - клетка с y = k */
+            struct Chunk {
+                word_t columns[CHUNK_SIZE];
+            };
+
+            static const Chunk EMPTY_CHUNK;
+
+            /** Свободные участки, которые хранятся всегда, даже если шагу столько не понадобилось */
+            static constexpr int MIN_FREE_CHUNKS = 64;
+
+            unordered_map<uint64_t, Chunk*> chunks;
+            vector<Chunk*> freeChunks; // Не больше, чем участков понадобилось на последнем шаге
+            int processedChunksCount = 0;
+
+            // Переиспользуются между шагами, чтобы не выделять память каждый раз
+            unordered_set<uint64_t> candidateKeys;
+            vector<uint64_t> keys;
+            vector<Chunk*> results;
+            vector<char> changedResults;
+
+            // Участки, изменившиеся с прошлого takeChangedTiles(). Если их накопилось заметно больше, чем хранимых участков,
+            // они забываются и отмечается, что измениться могло всё
+            unordered_set<uint64_t> untakenKeys;
+            bool untakenAll = false;
+
+            static inline uint64_t keyOf(int chunkX, int chunkY) {
+                return (uint64_t)(uint32_t)chunkX << 32 | (uint32_t)chunkY;
+            }
+
+            static inline int chunkXOf(uint64_t key) {
+                return (int32_t)(key >> 32);
+            }
+
+            static inline int chunkYOf(uint64_t key) {
+                return (int32_t)key;
+            }
+
+            static bool isEmpty(const Chunk*);
+
+            const Chunk* findChunk(int chunkX, int chunkY) const;
+
+            Chunk* newChunk();
+
+            void markChanged(uint64_t key);
+
+            void stepChunk(int chunkX, int chunkY, Chunk* result, const BitRules&) const;
+
+            /** Устанавливает в прямоугольнике видимой области все клетки в on */
+            void fillWith(bool on);
+
+        public:
+            ChunkField(int width, int height);
+            virtual ~ChunkField();
+
+            virtual bool get(int x, int y) const override;
+
+            virtual void set(int x, int y, bool on) override;
+
+            virtual void resize(int width, int height) override;
+
+            using Field::step;
+
+            virtual void step(const Rules&, const CheckZone&) override;
+
+            virtual void clear() override;
+
+            virtual void fill() override;
+
+            using Field::forEachOn;
+
+            virtual void forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const override;
+
+            /** Учитывает всю вселенную, а не только видимую область */
+            virtual uint64_t hash() override;
+
+            /** Число участков, пересчитанных на последнем шаге (заселённые и их соседи) */
+            virtual int getActiveTilesCount() const override;
+
+            /** Число хранимых участков */
+            virtual int getTilesCount() const override;
+
+            virtual int getChangedTileSize() const override;
+
+            virtual bool takeChangedTiles(vector<Tile>& tiles) override;
+
+            virtual uint32_t countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const override;
+    };
+}
+
+#endif // LIFEGAME_CHUNK_FIELD_H
@@ -0,0 +1,146 @@
+#ifndef LIFEGAME_COLUMN_COUNTERS_H
+#define LIFEGAME_COLUMN_COUNTERS_H
+
+#include <cstdint>
+#include "cell.h"
+#include "check_zone.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LIFEGAME_X86
+#endif
+
+namespace lifegame {
+
+    // Реализации подсчёта соседей для столбца клеток под разные наборы инструкций.
+    // Окрестность задаётся параметром шаблона, чтобы проверки соседей раскрывались при компиляции.
+    // Клетка хранит состояние в младшем бите, остальные биты маскируются
+
+    static inline const char* bytes(const Cell* cells) {
+        return reinterpret_cast<const char*>(cells);
+    }
+
+    template<int neighbourhood>
+    static inline void countScalar(const char* const rows[3], uint8_t* counts, int start, int end) {
+        for(int y = start; y < end; ++y) {
+            int count = 0;
+
+            for(int dx = -1; dx <= 1; ++dx) {
+                for(int dy = -1; dy <= 1; ++dy) {
+                    if(neighbourhood & neighbourBit(dx, dy))
+                        count += rows[dx + 1][y + dy] & CELL_ON;
+                }
+            }
+
+            counts[y] = count;
+        }
+    }
+
+    template<int neighbourhood>
+    static void countColumnScalar(const Cell* prevRow, const Cell* currRow, const Cell* nextRow, uint8_t* counts, int count) {
+        const char* const rows[3] = { bytes(prevRow), bytes(currRow), bytes(nextRow) };
+        countScalar<neighbourhood>(rows, counts, 0, count);
+    }
+
+    #ifdef LIFEGAME_X86
+
+    template<int neighbourhood>
+    __attribute__((target("sse2")))
+    static inline void countColumnSse2(const Cell* prevRow, const Cell* currRow, const Cell* nextRow, uint8_t* counts, int count) {
+        const char* const rows[3] = { bytes(prevRow), bytes(currRow), bytes(nextRow) };
+        const __m128i one = _mm_set1_epi8(CELL_ON);
+
+        int y = 0;
+
+        for(; y + 16 <= count; y += 16) {
+            __m128i sum = _mm_setzero_si128();
+
+            for(int dx = -1; dx <= 1; ++dx) {
+                for(int dy = -1; dy <= 1; ++dy) {
+                    if(neighbourhood & neighbourBit(dx, dy)) {
+                        const __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[dx + 1] + y + dy));
+                        sum = _mm_add_epi8(sum, _mm_and_si128(cells, one));
+                    }
+                }
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(counts + y), sum);
+        }
+
+        countScalar<neighbourhood>(rows, counts, y, count);
+    }
+
+    template<int neighbourhood>
+    __attribute__((target("avx2")))
+    static inline void countColumnAvx2(const Cell* prevRow, const Cell* currRow, const Cell* nextRow, uint8_t* counts, int count) {
+        const char* const rows[3] = { bytes(prevRow), bytes(currRow), bytes(nextRow) };
+        const __m256i one = _mm256_set1_epi8(CELL_ON);
+
+        int y = 0;
+
+        for(; y + 32 <= count; y += 32) {
+            __m256i sum = _mm256_setzero_si256();
+
+            for(int dx = -1; dx <= 1; ++dx) {
+                for(int dy = -1; dy <= 1; ++dy) {
+                    if(neighbourhood & neighbourBit(dx, dy)) {
+                        const __m256i cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[dx + 1] + y + dy));
+                        sum = _mm256_add_epi8(sum, _mm256_and_si256(cells, one));
+                    }
+                }
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(counts + y), sum);
+        }
+
+        countScalar<neighbourhood>(rows, counts, y, count);
+    }
+
+    template<int neighbourhood>
+    __attribute__((target("avx512f,avx512bw")))
+    static inline void countColumnAvx512(const Cell* prevRow, const Cell* currRow, const Cell* nextRow, uint8_t* counts, int count) {
+        const char* const rows[3] = { bytes(prevRow), bytes(currRow), bytes(nextRow) };
+        const __m512i one = _mm512_set1_epi8(CELL_ON);
+
+        int y = 0;
+
+        for(; y + 64 <= count; y += 64) {
+            __m512i sum = _mm512_setzero_si512();
+
+            for(int dx = -1; dx <= 1; ++dx) {
+                for(int dy = -1; dy <= 1; ++dy) {
+                    if(neighbourhood & neighbourBit(dx, dy)) {
+                        const __m512i cells = _mm512_loadu_si512(rows[dx + 1] + y + dy);
+                        sum = _mm512_add_epi8(sum, _mm512_and_si512(cells, one));
+                    }
+                }
+            }
+
+            _mm512_storeu_si512(counts + y, sum);
+        }
+
+        countScalar<neighbourhood>(rows, counts, y, count);
+    }
+
+    #endif // LIFEGAME_X86
+
+
+    template<int neighbourhood, SimdLevel level>
+    static inline void countColumn(const Cell* prevRow, const Cell* currRow, const Cell* nextRow, uint8_t* counts, int count) {
+        #ifdef LIFEGAME_X86
+        if constexpr(level == SIMD_AVX512) {
+            countColumnAvx512<neighbourhood>(prevRow, currRow, nextRow, counts, count);
+        } else if constexpr(level == SIMD_AVX2) {
+            countColumnAvx2<neighbourhood>(prevRow, currRow, nextRow, counts, count);
+        } else if constexpr(level == SIMD_SSE2) {
+            countColumnSse2<neighbourhood>(prevRow, currRow, nextRow, counts, count);
+        } else {
+            countColumnScalar<neighbourhood>(prevRow, currRow, nextRow, counts, count);
+        }
+        #else
+        countColumnScalar<neighbourhood>(prevRow, currRow, nextRow, counts, count);
+        #endif // LIFEGAME_X86
+    }
+}
+
+#endif // LIFEGAME_COLUMN_COUNTERS_H
@@ -0,0 +1,67 @@
+#ifndef LIFEGAME_CYCLE_DETECTOR_H
+#define LIFEGAME_CYCLE_DETECTOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace lifegame {
+
+    using std::vector;
+
+    /** Что делать, когда поле зациклилось */
+    enum CycleAction {
+        CYCLE_OFF,   // Не искать циклы
+        CYCLE_PAUSE, // Поставить на паузу
+        CYCLE_SKIP,  // Продолжать, вычисляя лишь остаток от деления числа поколений на период
+        CYCLE_IDLE,  // Перестать вычислять поколения до изменения поля или правил
+        CYCLE_ACTIONS
+    };
+
+    extern const char* const CYCLE_ACTION_NAMES[CYCLE_ACTIONS];
+
+    /**
+     * Хранит хеши последних HISTORY_SIZE проверенных поколений и находит повторения состояния.
+     * Поколения могут проверяться не подряд, тогда найденное расстояние кратно периоду
+     */
+    class CycleDetector {
+        public:
+            static const int HISTORY_SIZE = 64;
+
+        private:
+            struct Entry {
+                uint64_t generation, hash;
+            };
+
+            vector<Entry> history;
+            int nextEntry = 0;
+
+            uint64_t period = 0, cycleStart = 0;
+
+        public:
+            void reset();
+
+            /**
+             * Запоминает хеш поколения. Если такой хеш уже встречался, возвращает расстояние
+             * до последнего такого поколения и запоминает самое раннее из них как начало цикла, иначе 0
+             */
+            uint64_t add(uint64_t generation, uint64_t hash);
+
+            /** Запоминает найденный цикл, пока не будет вызван reset() */
+            void setPeriod(uint64_t period);
+
+            inline bool hasCycle() const {
+                return period != 0;
+            }
+
+            inline uint64_t getPeriod() const {
+                return period;
+            }
+
+            /** Самое раннее проверенное поколение, с которого состояние повторяется */
+            inline uint64_t getCycleStart() const {
+                return cycleStart;
+            }
+    };
+}
+
+#endif // LIFEGAME_CYCLE_DETECTOR_H
@@ -0,0 +1,73 @@
+#ifndef LIFEGAME_DENSITY_MIPMAP_H
+#define LIFEGAME_DENSITY_MIPMAP_H
+
+#include <cstdint>
+#include <vector>
+#include "field.h"
+
+namespace lifegame {
+
+    using std::vector;
+
+    /**
+     * Пирамида плотности прямоугольной области поля: на уровне k хранится доля живых клеток в блоках 2^k x 2^k (0..255).
+     * Уровень 0 - сами клетки, он не хранится: клетки читаются из поля.
+     * Область расширяется до границ участков поля, и пирамида обновляется только по участкам, которые поле отметило как изменившиеся
+     */
+    class DensityMipmap {
+        public:
+            /** Сторона участков, по которым пирамида строится для полей, не отслеживающих изменения */
+            static const int DEFAULT_TILE_SIZE = 64;
+
+        private:
+            int startX = 0, startY = 0, width = 0, height = 0; // Запрошенная область
+            int originX = 0, originY = 0;                      // Левый верхний угол хранимой области, кратен tileSize
+            int tileSize = 0, tilesWidth = 0, tilesHeight = 0;
+            vector<vector<uint8_t>> levels; // levels[k - 1][x * levelHeight(k) + y], x и y отсчитываются от origin
+
+            vector<uint32_t> tilePopulations;
+            uint64_t population = 0;
+
+            vector<Field::Tile> changedTiles;
+            vector<uint8_t> tileCounts; // Живых клеток в блоках 2x2 одного участка, tileCounts[x * (tileSize / 2) + y]
+
+            inline int levelWidth(int level) const {
+                return (tilesWidth * tileSize + (1 << level) - 1) >> level;
+            }
+
+            inline int levelHeight(int level) const {
+                return (tilesHeight * tileSize + (1 << level) - 1) >> level;
+            }
+
+            /** Пересчитывает число живых клеток участка (по индексу в хранимой области) и блоки уровня 1 в нём */
+            void updateTile(const Field&, int tileX, int tileY);
+
+            /** Пересчитывает блоки [startX, endX) x [startY, endY) уровня level > 1 по четырём блокам предыдущего уровня */
+            void updateBlocks(int level, int startX, int startY, int endX, int endY);
+
+        public:
+            /**
+             * Обновляет уровни 1..levelsCount области [startX, startX + width) x [startY, startY + height)
+             * по участкам поля, которые вернул takeChangedTiles(). Пирамида строится заново, если поле не отслеживает изменения,
+             * изменились область или число уровней либо блок верхнего уровня не помещается в один участок
+             */
+            void update(Field&, int levelsCount, int startX, int startY, int width, int height);
+
+            /**
+             * Копирует в density[x * blocksHeight + y] блоки уровня level, покрывающие клетки
+             * [startX, startX + width) x [startY, startY + height) внутри области последнего update(); startX и startY кратны 2^level.
+             * Уровень 0 берётся из поля
+             */
+            void copyLevel(const Field&, int level, int startX, int startY, int width, int height, vector<uint8_t>& density) const;
+
+            /** Число живых клеток в хранимой области на момент последнего update() */
+            inline uint64_t getPopulation() const {
+                return population;
+            }
+
+            /** Освобождает память */
+            void clear();
+    };
+}
+
+#endif // LIFEGAME_DENSITY_MIPMAP_H
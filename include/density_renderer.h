@@ -0,0 +1,34 @@
+#ifndef LIFEGAME_DENSITY_RENDERER_H
+#define LIFEGAME_DENSITY_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+#include "renderer.h"
+
+namespace lifegame {
+
+    using std::vector;
+
+    /**
+     * Рисует уменьшенный снимок (Snapshot::blockSize != 0): каждый пиксель - блок клеток,
+     * яркость пикселя - доля живых клеток в блоке. Время кадра зависит только от размера окна
+     */
+    class DensityRenderer: public Renderer {
+        private:
+            vector<Uint8> pixels; // RGBA
+            Texture texture;
+            Sprite sprite;
+
+            uint64_t lastSerial = 0;
+
+            /** Яркость блока: любой непустой блок заметен, дальше яркость растёт с плотностью */
+            static inline Uint8 brightness(uint8_t density) {
+                return density == 0 ? 0 : 63 + density * 192 / 255;
+            }
+
+        public:
+            virtual void draw(RenderTarget&, const Snapshot&, int width, int height) override;
+    };
+}
+
+#endif // LIFEGAME_DENSITY_RENDERER_H
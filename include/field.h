@@ -0,0 +1,187 @@
+#ifndef LIFEGAME_FIELD_H
+#define LIFEGAME_FIELD_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "rules.h"
+#include "check_zone.h"
+#include "thread_pool.h"
+
+namespace lifegame {
+
+    using std::function;
+    using std::string;
+    using std::vector;
+
+    /** Как соединяются края поля */
+    enum Topology {
+        TOPOLOGY_PLANE, // Клетки за краями поля не изменяются, но учитываются как соседи
+        TOPOLOGY_DEAD,  // За краями поля всегда мёртвые клетки
+        TOPOLOGY_TORUS, // Противоположные края склеены
+        TOPOLOGY_KLEIN, // Бутылка Клейна: верхний край склеен с нижним, левый с правым с переворотом по вертикали
+        TOPOLOGIES
+    };
+
+    extern const char* const TOPOLOGY_NAMES[TOPOLOGIES];
+
+    /**
+     * Поле клеток: хранит текущее поколение и вычисляет следующее.
+     * Размер поля (width x height) меняется при масштабировании, содержимое при этом сохраняется.
+     * Клетки за пределами текущего размера не изменяются, но учитываются как соседи
+     */
+    class Field {
+        public:
+            static const vector<string> types;
+
+            /** Участок поля: клетки [x * size, (x + 1) * size) x [y * size, (y + 1) * size), где size = getChangedTileSize() */
+            struct Tile {
+                int x, y;
+            };
+
+            /**
+             * Создаёт поле по имени типа ("cell", "bit", "hashlife", "chunk").
+             * Бросает invalid_argument, если тип неизвестен
+             */
+            static Field* create(const string& type, int width, int height);
+
+        protected:
+            int width, height;
+            Topology topology = TOPOLOGY_PLANE;
+            ThreadPool* threadPool = nullptr;
+
+            /** Выполняет func(i) для i из [0, count) в пуле потоков, если он задан */
+            void parallelFor(int count, const function<void(int)>& func);
+
+            /** Число полос, на которые стоит разбить count столбцов или участков для parallelFor */
+            int bandsFor(int count) const;
+
+            /** Финальное перемешивание хеша (splitmix64) */
+            static inline uint64_t mixHash(uint64_t hash) {
+                hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9;
+                hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EB;
+                return hash ^ (hash >> 31);
+            }
+
+            /** Добавляет к хешу очередное слово данных */
+            static inline uint64_t hashWord(uint64_t hash, uint64_t word) {
+                hash = (hash ^ word) * 0x9E3779B97F4A7C15;
+                return hash ^ (hash >> 29);
+            }
+
+            /**
+             * Прибавляет к counts[k] число живых клеток в блоке 2x2 из строк 2k и 2k + 1 двух соседних столбцов,
+             * упакованных в слова left и right (бит y - клетка в строке y)
+             */
+            static inline void countWordBlocks(uint64_t left, uint64_t right, uint8_t* counts) {
+                const uint64_t
+                        pairs = 0x5555555555555555, nibbles = 0x3333333333333333,
+                        leftPairs = (left & pairs) + ((left >> 1) & pairs), // В паре бит k - живых клеток столбца в блоке k
+                        rightPairs = (right & pairs) + ((right >> 1) & pairs);
+
+                // Сумма двух столбцов (до 4) не помещается в пару бит, поэтому чётные и нечётные блоки складываются по четыре бита
+                for(int parity = 0; parity < 2; ++parity) {
+                    uint64_t sums = ((leftPairs >> (parity * 2)) & nibbles) + ((rightPairs >> (parity * 2)) & nibbles);
+
+                    while(sums != 0) {
+                        const int nibble = __builtin_ctzll(sums) / 4;
+
+                        counts[nibble * 2 + parity] += (sums >> (nibble * 4)) & 15;
+                        sums &= ~((uint64_t)15 << (nibble * 4));
+                    }
+                }
+            }
+
+        public:
+            Field(int width, int height):
+                    width(width), height(height) {}
+
+            virtual ~Field() {}
+
+            inline int getWidth() const {
+                return width;
+            }
+
+            inline int getHeight() const {
+                return height;
+            }
+
+            inline Topology getTopology() const {
+                return topology;
+            }
+
+            /** Неограниченные поля поддерживают только TOPOLOGY_PLANE */
+            virtual bool supportsTopology(Topology) const;
+
+            /**
+             * Поле не ограничено размером: width x height - лишь начальная область,
+             * клетки можно читать и менять за её пределами, в том числе по отрицательным координатам
+             */
+            inline bool isUnbounded() const {
+                return !supportsTopology(TOPOLOGY_TORUS);
+            }
+
+            /**
+             * При любой топологии, кроме TOPOLOGY_PLANE, клетки за пределами поля удаляются.
+             * Бросает invalid_argument, если поле не поддерживает топологию
+             */
+            virtual void setTopology(Topology);
+
+            /** Пул потоков для step(). Поле не владеет пулом */
+            void setThreadPool(ThreadPool*);
+
+            virtual bool get(int x, int y) const = 0;
+
+            virtual void set(int x, int y, bool on) = 0;
+
+            virtual void resize(int width, int height) = 0;
+
+            virtual void step(const Rules&, const CheckZone&) = 0;
+
+            /** Вычисляет generations поколений подряд. Промежуточные поколения могут не сохраняться */
+            virtual void step(const Rules&, const CheckZone&, int generations);
+
+            virtual void fillRandom();
+
+            virtual void clear();
+
+            virtual void fill();
+
+            /** Вызывает func для каждой живой клетки в прямоугольнике [startX, endX) x [startY, endY) */
+            virtual void forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const;
+
+            void forEachOn(function<void(int, int)> func) const;
+
+            /**
+             * Хеш текущего поколения: одинаковые состояния поля дают одинаковый хеш.
+             * По умолчанию учитывается видимая область
+             */
+            virtual uint64_t hash();
+
+            /** Число участков, пересчитанных на последнем шаге */
+            virtual int getActiveTilesCount() const;
+
+            /** Общее число участков или 0, если поле не разбито на участки */
+            virtual int getTilesCount() const;
+
+            /** Сторона квадратных участков, изменения которых отслеживает takeChangedTiles(), или 0, если поле их не отслеживает */
+            virtual int getChangedTileSize() const;
+
+            /**
+             * Записывает в tiles участки, изменившиеся с прошлого вызова, и забывает о них.
+             * Возвращает false, если поле не отслеживает изменения или не может их перечислить и измениться могло всё.
+             * У изменений один получатель: два разных вызывающих не увидят одних и тех же участков
+             */
+            virtual bool takeChangedTiles(vector<Tile>& tiles);
+
+            /**
+             * Прибавляет к counts[(x - startX) / 2 * countsHeight + (y - startY) / 2] число живых клеток в каждом блоке 2x2
+             * прямоугольника [startX, endX) x [startY, endY) и возвращает число живых клеток в нём. startX и startY чётные.
+             * Ограниченные поля не считают клетки за своими пределами
+             */
+            virtual uint32_t countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const;
+    };
+}
+
+#endif // LIFEGAME_FIELD_H
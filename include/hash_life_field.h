@@ -0,0 +1,163 @@
+#ifndef LIFEGAME_HASH_LIFE_FIELD_H
+#define LIFEGAME_HASH_LIFE_FIELD_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "field.h"
+
+namespace lifegame {
+
+    using std::size_t;
+    using std::vector;
+
+    /**
+     * Поле на основе алгоритма HashLife: вселенная хранится как квадродерево
+     * с общими (хешированными) узлами, а результат эволюции каждого узла запоминается.
+     * Вселенная не ограничена размером поля: width и height задают лишь видимую область.
+     * Правила с рождением при 0 соседей не поддерживаются
+     */
+    class HashLifeField: public Field {
+        public:
+            static const int MAX_LEVEL = 62;
+
+            /** Ограничение памяти под узлы по умолчанию, в байтах */
+            static size_t defaultMemoryLimit;
+
+        protected:
+            struct Node {
+                Node *nw, *ne, *sw, *se; // У листьев (уровень 0) все nullptr
+                Node* next;              // Следующий узел в цепочке хеш-таблицы
+                Node* result;            // Центр узла через 2^resultExponent поколений
+                uint64_t population;
+                uint64_t contentHash;    // Зависит только от клеток узла, а не от адресов потомков
+                int level;
+                signed char resultExponent; // min(stepExponent, level - 2) на момент вычисления result
+                bool marked;
+            };
+
+            Node deadLeaf, aliveLeaf;
+
+            vector<Node*> buckets;
+            size_t nodesCount = 0;
+            size_t memoryLimit;
+
+            vector<Node*> emptyNodes; // emptyNodes[level] - пустой узел этого уровня
+
+            Node* root;
+
+            // Текущий шаг - 2^stepExponent поколений. Результаты узлов уровня не выше stepExponent + 2
+            // (полный шаг) от него не зависят, поэтому при смене шага сохраняются
+            int stepExponent = -1;
+
+            // Правила, при которых были вычислены Node::result
+            rule_t resultBirth = 0, resultSurvive = 0;
+            int resultNeighbourhood = -1;
+
+            // Во время advance() выделение узлов сверх memoryLimit прерывает вычисление
+            bool limitMemory = false;
+
+            /** Бросается из join(), если при limitMemory превышен memoryLimit */
+            struct MemoryLimitExceeded {};
+
+            // Копия правил для базового случая
+            bool birth[MAX_RULE_NUMS + 1], survive[MAX_RULE_NUMS + 1];
+            int neighbourhood = 0;
+
+        public:
+            HashLifeField(int width, int height, size_t memoryLimit = defaultMemoryLimit);
+            virtual ~HashLifeField();
+
+            virtual bool get(int x, int y) const override;
+
+            virtual void set(int x, int y, bool on) override;
+
+            virtual void resize(int width, int height) override;
+
+            virtual void step(const Rules&, const CheckZone&) override;
+
+            /** Раскладывает generations по степеням двойки и продвигает вселенную на каждую из них */
+            virtual void step(const Rules&, const CheckZone&, int generations) override;
+
+            /**
+             * Продвигает вселенную сразу на 2^exponent поколений.
+             * Если на это не хватает memoryLimit, шаг разбивается на два вдвое меньших
+             */
+            void advance(int exponent, const Rules&, const CheckZone&);
+
+            virtual void fillRandom() override;
+
+            virtual void clear() override;
+
+            virtual void fill() override;
+
+            using Field::forEachOn;
+
+            virtual void forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const override;
+
+            virtual uint32_t countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const override;
+
+            /** Хеш всей вселенной, не зависящий от того, сколько раз был расширен корень */
+            virtual uint64_t hash() override;
+
+            uint64_t getPopulation() const;
+
+            size_t getNodesCount() const;
+
+            size_t getMemoryUsage() const;
+
+            void setMemoryLimit(size_t memoryLimit);
+
+            /** Удаляет узлы, недостижимые из корня. Если памяти всё ещё мало, сбрасывает кеш результатов */
+            void collectGarbage();
+
+        protected:
+            Node* join(Node* nw, Node* ne, Node* sw, Node* se);
+
+            Node* empty(int level);
+
+            Node* expand(Node*);
+
+            Node* centre(Node*);
+
+            Node* horizontalCentre(Node* w, Node* e);
+
+            Node* verticalCentre(Node* n, Node* s);
+
+            Node* leafStep(Node*);
+
+            Node* successor(Node*);
+
+            bool isPadded(Node*) const;
+
+            static uint64_t contentHashOf(int level, const Node* nw, const Node* ne, const Node* sw, const Node* se);
+
+            void setRules(int exponent, const Rules&, const CheckZone&);
+
+            void clearResults();
+
+            void rehash(size_t bucketsCount);
+
+            void mark(Node*);
+
+            void sweep();
+
+            /** Половина стороны корня: корень покрывает [-half, half) по обеим осям */
+            int64_t rootHalf() const;
+
+            Node* setCell(Node*, int64_t x, int64_t y, bool on);
+
+            /** Заменяет клетки видимой области значениями func(x, y) */
+            void fillVisible(function<bool(int64_t, int64_t)> func);
+
+            Node* fillNode(Node*, int64_t x, int64_t y, const function<bool(int64_t, int64_t)>& func);
+
+            void forEachOn(const Node*, int64_t x, int64_t y, int64_t startX, int64_t startY, int64_t endX, int64_t endY,
+                           const function<void(int, int)>& func) const;
+
+            uint32_t countBlocks(const Node*, int64_t x, int64_t y, int64_t startX, int64_t startY, int64_t endX, int64_t endY,
+                                 uint8_t* counts, int countsHeight) const;
+    };
+}
+
+#endif // LIFEGAME_HASH_LIFE_FIELD_H
@@ -0,0 +1,34 @@
+#ifndef LIFEGAME_INCREMENTAL_RENDERER_H
+#define LIFEGAME_INCREMENTAL_RENDERER_H
+
+#include <cstdint>
+#include "renderer.h"
+
+namespace lifegame {
+
+    /**
+     * Хранит нарисованное поле в RenderTexture и перерисовывает в ней только плитки,
+     * изменившиеся с последнего нарисованного снимка (Snapshot::dirtyTiles).
+     * В окно каждый кадр копируется вся текстура одним спрайтом
+     */
+    class IncrementalRenderer: public Renderer {
+        private:
+            RenderTexture canvas;
+            Sprite canvasSprite;
+            VertexArray quads{Quads};
+
+            // Что нарисовано в canvas
+            uint64_t lastSerial = 0;
+            int lastCellSize = 0, lastWidth = 0, lastHeight = 0;
+
+            /** Добавляет в quads чёрный квадрат плитки и белые квадраты её живых клеток */
+            void addTile(const Snapshot&, int tileX, int tileY, int width, int height);
+
+            void update(const Snapshot&, int width, int height);
+
+        public:
+            virtual void draw(RenderTarget&, const Snapshot&, int width, int height) override;
+    };
+}
+
+#endif // LIFEGAME_INCREMENTAL_RENDERER_H
@@ -5,10 +5,9 @@
 #include <functional>
 #include <chrono>
 #include <thread>
-
-#ifdef DRAW_PARALLEL
+#include <atomic>
 #include <mutex>
-#endif // DRAW_PARALLEL
+#include <condition_variable>
 
 #include <future>
 #include <iostream>
@@ -16,6 +15,16 @@
 #include "cell.h"
 #include "rules.h"
 #include "check_zone.h"
+#include "field.h"
+#include "cycle_detector.h"
+#include "snapshot.h"
+#include "renderer.h"
+#include "density_renderer.h"
+#include "density_mipmap.h"
+#include "triple_buffer.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "thread_pool.h"
 #include "util.h"
 
 namespace lifegame {
@@ -30,6 +39,12 @@ namespace lifegame {
     using std::function;
     using std::to_string;
     using std::initializer_list;
+    using std::atomic;
+    using std::mutex;
+    using std::condition_variable;
+    using std::lock_guard;
+    using std::unique_lock;
+    using std::exception;
 
     using clock = std::chrono::steady_clock;
     using duration   = clock::duration;
@@ -39,51 +54,128 @@ namespace lifegame {
 
     namespace this_thread = std::this_thread;
 
-    #ifdef DRAW_PARALLEL
-    using std::thread;
-    using std::mutex;
-    using std::future;
-    using std::async;
-    using std::launch;
-    #endif // DRAW_PARALLEL
-
     static const char* const TITLE = "Life Game";
 
+    /**
+     * Окно игры. Поколения вычисляются в отдельном потоке симуляции, который после каждой пачки поколений
+     * публикует снимок поля через тройной буфер; основной поток обрабатывает события и рисует последний снимок.
+     * Поле и состояние симуляции (поколение, циклы, правила) меняет только поток симуляции:
+     * основной поток передаёт ему изменения командами через post()
+     */
     class LifeGame {
-            static const duration MAX_SLEEP_TIME, MIN_DELAY, MAX_DELAY, MIN_RENDER_DELAY;
+            static const duration MIN_DELAY, MAX_DELAY, MIN_RENDER_DELAY, PROGRESS_DELAY;
+            static const int MAX_ADVANCE_BATCH = 1 << 20;
+
+            // Уменьшение меньше MIN_CELL_SIZE: на уровне lodLevel пиксель показывает блок 2^(lodLevel - 1) клеток
+            static constexpr int MAX_LOD_LEVEL = 4;
             static const vector<Rules> RULES;
 
+            #ifdef PROFILE
+            static const duration PROFILE_UPDATE_DELAY;
+
+            /** Что показывает profileText (клавиша F2) */
+            enum ProfileView {
+                PROFILE_HIDDEN,
+                PROFILE_SUMMARY, // Поколений в секунду, время кадра и число живых клеток
+                PROFILE_PHASES,  // p50/p99 каждой фазы кадра
+                PROFILE_VIEWS
+            };
+            #endif // PROFILE
+
             static const int
                     TOOLBAR_HEIGHT = 32,
                     CHAR_WIDTH = 16,
                     TOOLBAR_TEXT_OFFSET = 32 - CHAR_WIDTH / 2;
 
-            int dataWidth, dataHeight;
+            int lodLevel = 0; // 0 - клетки рисуются размером CELL_SIZE
+
+            // Видимая часть поля: левый верхний угол (viewX, viewY) и размер width x height в клетках, зависящий от окна.
+            // Поле размером fieldWidth x fieldHeight может быть больше окна; 0 - поле совпадает с видимой частью
+            int viewX = 0, viewY = 0;
             int width, height;
-            Cell* const* data;
+            int fieldWidth = 0, fieldHeight = 0;
+            Field* field;
+            ThreadPool threadPool;
 
             RenderWindow window;
             bool fullscreen;
 
-            bool paused;
+            // Поток симуляции и очередь команд для него
+            std::thread simulation;
+            mutex commandsMutex;
+            condition_variable commandsCondition;
+            vector<function<void()>> commands;
+            bool stopping = false;
+
+            TripleBuffer<Snapshot> snapshots;
+            uint64_t publishedSnapshots = 0; // Только для потока симуляции
+            bool publishPending = false;     // Снимок отложен до того, как поток отрисовки заберёт предыдущий. Только для потока симуляции
+            ChangeTracker changeTracker;      // Только для потока симуляции
+            atomic<uint64_t> acquiredSnapshot{0}; // serial последнего снимка, полученного потоком отрисовки
+
+            IntRect viewport; // Видимая часть поля для снимков, только для потока симуляции
+
+            // Уменьшенный вид, только для потока симуляции: уровень пирамиды для снимков (-1 - снимок с клетками)
+            // и пирамида плотности, обновляемая по изменившимся участкам поля
+            int snapshotLevel = -1;
+            DensityMipmap mipmap;
+
+            Renderer* renderer;
+            DensityRenderer densityRenderer;
+
+            atomic<bool> paused{true}; // Меняется под commandsMutex, чтобы поток симуляции не пропустил снятие паузы
+
+            // Состояние симуляции, доступное только потоку симуляции
+            uint64_t generation = 0;
+            CycleDetector cycleDetector;
+            bool idle = false; // Поле зациклилось при CYCLE_IDLE
+            int jumpProgress = -1;
+            time_point timePoint = clock::now(); // Когда вычислять следующую пачку поколений
+
+            atomic<CycleAction> cycleAction{CYCLE_OFF};
+
+            // Переход к поколению, выполняемый потоком симуляции
+            atomic<bool> advancing{false}, cancelAdvance{false};
+
+            // Ввод номера поколения для перехода (клавиша G)
+            bool jumpInput = false;
+            string jumpTarget;
 
             bool userErasing = false;
             Vector2i userDrawingPos{-1, -1};
 
-            const Rules* rules;
-            const CheckZone* checkZone;
+            // Перетаскивание видимой части средней кнопкой мыши: где нажата кнопка и где тогда была видимая часть
+            Vector2i panningPos{-1, -1}, panningView;
+
+            const Rules* rules = nullptr;         // Только для потока симуляции
+            const CheckZone* checkZone = nullptr; // Только для потока симуляции
             unsigned int checkZoneIndex = 0;
+            Topology topology = TOPOLOGY_PLANE;
 
-            time_point
-                    timePoint = clock::now(),
-                    renderTimePoint = timePoint;
+            atomic<duration> delay{duration::zero()};
 
-            duration delay;
+            time_point frameTimePoint = clock::now();
 
             Font defaultTextFont;
             int textXOffset = CHAR_WIDTH;
-            Text pausedText, rulesText, checkZoneText, speedText, scaleText;
-            vector<Text*> texts = { &pausedText, &rulesText, &checkZoneText, &speedText, &scaleText };
+            Text pausedText, rulesText, checkZoneText, topologyText, speedText, scaleText, generationText, cycleText;
+
+            #ifdef PROFILE
+            Text profileText;
+            #endif // PROFILE
+
+            vector<Text*> texts = { &pausedText, &rulesText, &checkZoneText, &topologyText, &speedText, &scaleText, &generationText, &cycleText,
+                #ifdef PROFILE
+                &profileText,
+                #endif // PROFILE
+            };
+
+            #ifdef PROFILE
+            Profiler profiler;
+            ProfileView profileView = PROFILE_HIDDEN;
+            atomic<uint64_t> profileGenerations{0}; // Вычислено с profileTimePoint
+            time_point profileTimePoint = clock::now();
+            #endif // PROFILE
 
 
             class HelpElement: public Drawable {
@@ -113,30 +205,47 @@ namespace lifegame {
             int widthOf(int width);
             int heightOf(int width);
 
+            /**
+             * Размер поля: заданный setFieldSize() или, если поле следует за окном, размер окна в клетках CELL_SIZE.
+             * Уменьшенный вид его не меняет, а показывает поле целиком
+             */
+            Vector2i getFieldSize() const;
+
+            /** Подгоняет видимую часть под окно при текущих CELL_SIZE и lodLevel, сохраняя её центр */
+            void resizeView();
+
+            /** Меняет размер поля в потоке симуляции */
+            void resizeField(int width, int height);
+
+            /** Сдвигает видимую часть так, чтобы её левый верхний угол был в клетке (x, y), не выходя за поле */
+            void moveView(int x, int y);
+
         public:
             void setPause(bool paused);
             void setRules(const Rules*);
             void setCheckZone(const CheckZone*);
+            /** Бросает invalid_argument, если поле не поддерживает топологию */
+            void setTopology(Topology);
+            void setCycleAction(CycleAction);
             void setDelay(duration delay);
             void setScale(int scale);
 
-            void incScale(int extent);
-
-            LifeGame(VideoMode, bool fullscreen = false, string defaultFontName = "sans-serif.ttf");
-            ~LifeGame();
-
-        protected:
-            void extendDataIfNecessary();
+            /** Задаёт размер поля независимо от окна; 0 - поле совпадает с видимой частью */
+            void setFieldSize(int width, int height);
 
-            void forEachCell(function<void(int, int, Cell&)>);
+            /** Уменьшает поле меньше MIN_CELL_SIZE; 0 - обычный вид с масштабом CELL_SIZE */
+            void setLodLevel(int level);
 
-            void forEachCell(int x, int y, int endX, int endY, function<void(int, int, Cell&)>);
+            void incScale(int extent);
 
-            #ifdef DRAW_PARALLEL
-            void forEachCellParallel(function<void(int, int, Cell&)> parallelFunc, function<void(int, int, Cell&)> func);
-            #endif // DRAW_PARALLEL
+            /** Поколение последнего полученного снимка */
+            inline uint64_t getGeneration() const {
+                return snapshots.getFront().generation;
+            }
 
-            void clearBorder();
+            LifeGame(VideoMode, bool fullscreen = false, string defaultFontName = "sans-serif.ttf", string fieldType = "cell",
+                     unsigned threadsCount = 0, string rendererType = "incremental");
+            ~LifeGame();
 
         public:
             void fillRandom();
@@ -145,10 +254,52 @@ namespace lifegame {
 
             void fill();
 
+            /**
+             * Переходит к поколению target, вычисляя поколения подряд без отрисовки.
+             * Вычисление идёт в потоке симуляции; пока оно не закончено, Esc его прерывает
+             */
+            void jumpTo(uint64_t target);
+
         protected:
+            /** Выполняет command в потоке симуляции перед следующей пачкой поколений */
+            void post(function<void()> command);
+
+            /** Цикл потока симуляции: выполняет команды, вычисляет поколения и публикует снимки */
+            void simulate();
+
+            /**
+             * Публикует снимок текущего состояния поля. В уменьшенном виде снимок откладывается, пока поток отрисовки
+             * не забрал предыдущий: пирамида тогда обновляется не чаще, чем перерисовывается окно
+             */
+            void publish();
+
+            /** Выводит ошибку поля, прерывает переход к поколению и ставит игру на паузу. Вызывается в потоке симуляции */
+            void reportError(const exception&);
+
+            void setGeneration(uint64_t generation);
+
+            void updateJumpText();
+
+            /** Обновляет надписи, зависящие от состояния симуляции, по последнему снимку */
+            void updateTexts();
+
+            /** Забывает найденный цикл; вызывается при любом изменении поля, кроме шага */
+            void resetCycle();
+
+            /** Проверяет, не повторилось ли состояние, и выполняет cycleAction */
+            void checkCycle();
+
+            bool processJumpInput(Event&);
+
+            #ifdef PROFILE
+            /** Раз в PROFILE_UPDATE_DELAY обновляет profileText */
+            void updateProfileText();
+            #endif // PROFILE
+
             bool processEvent(Event&);
 
         public:
+            /** Возвращает, нужно ли перерисовать окно */
             bool processEvents();
 
             void run();
@@ -158,8 +309,16 @@ namespace lifegame {
 
             void drawAll();
 
-        public:
-            void step();
+            /** Вызывается в потоке симуляции */
+            void step(int generations = 1);
+
+            /**
+             * Вычисляет generations поколений подряд без ожидания. Вызывается в потоке симуляции.
+             * Раз в PROGRESS_DELAY публикует снимок с прогрессом; Esc прерывает вычисление.
+             * advancing и cancelAdvance выставляются до отправки команды, в конце advancing сбрасывается.
+             * Возвращает число вычисленных поколений
+             */
+            uint64_t advance(uint64_t generations);
     };
 }
 
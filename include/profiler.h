@@ -0,0 +1,84 @@
+#ifndef LIFEGAME_PROFILER_H
+#define LIFEGAME_PROFILER_H
+
+/*
+ * Замер времени фаз кадра. Включается макросом PROFILE (-DPROFILE),
+ * без него PROFILE_SCOPE ничего не делает, а классы не объявляются
+ */
+
+#ifdef PROFILE
+
+#include <chrono>
+#include <mutex>
+
+namespace lifegame {
+
+    enum ProfilePhase {
+        PHASE_EVENTS,  // Обработка событий окна
+        PHASE_STEP,    // Вычисление поколений
+        PHASE_CYCLE,   // Поиск цикла
+        PHASE_DRAW,    // Отрисовка в буфер окна
+        PHASE_DISPLAY, // window.display()
+        PHASE_FRAME,   // Перерисовка окна: отрисовка и вывод
+        PHASES
+    };
+
+    extern const char* const PHASE_NAMES[PHASES];
+
+    /**
+     * Хранит последние SAMPLES замеров каждой фазы и считает по ним процентили.
+     * Фазы замеряются и в потоке симуляции, и в основном потоке, поэтому доступ защищён мьютексом
+     */
+    class Profiler {
+        public:
+            static const int SAMPLES = 256;
+
+        private:
+            struct Samples {
+                float values[SAMPLES]; // В миллисекундах
+                int next = 0, count = 0;
+            };
+
+            Samples samples[PHASES];
+            mutable std::mutex mtx;
+
+        public:
+            inline void add(ProfilePhase phase, std::chrono::steady_clock::duration time) {
+                std::lock_guard<std::mutex> lock(mtx);
+                Samples& phaseSamples = samples[phase];
+                phaseSamples.values[phaseSamples.next] = std::chrono::duration<float, std::milli>(time).count();
+                phaseSamples.next = (phaseSamples.next + 1) % SAMPLES;
+
+                if(phaseSamples.count < SAMPLES)
+                    ++phaseSamples.count;
+            }
+
+            /** Процентиль (от 0 до 100) последних замеров фазы в миллисекундах или 0, если замеров не было */
+            float percentile(ProfilePhase, float percent) const;
+    };
+
+    /** Добавляет в профилировщик время от создания до уничтожения объекта */
+    class ProfileScope {
+            Profiler& profiler;
+            const ProfilePhase phase;
+            const std::chrono::steady_clock::time_point start;
+
+        public:
+            inline ProfileScope(Profiler& profiler, ProfilePhase phase):
+                    profiler(profiler), phase(phase), start(std::chrono::steady_clock::now()) {}
+
+            inline ~ProfileScope() {
+                profiler.add(phase, std::chrono::steady_clock::now() - start);
+            }
+    };
+}
+
+#define PROFILE_SCOPE(profiler, phase) ProfileScope profileScope(profiler, phase)
+
+#else
+
+#define PROFILE_SCOPE(profiler, phase)
+
+#endif // PROFILE
+
+#endif // LIFEGAME_PROFILER_H
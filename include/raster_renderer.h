@@ -0,0 +1,46 @@
+#ifndef LIFEGAME_RASTER_RENDERER_H
+#define LIFEGAME_RASTER_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+#include "renderer.h"
+#include "thread_pool.h"
+
+namespace lifegame {
+
+    using std::vector;
+
+    /**
+     * Программно рисует клетки в буфер пикселей и загружает его в текстуру одним вызовом.
+     * Буфер делится на полосы строк клеток, каждую полосу рисует свой поток пула без блокировок
+     */
+    class RasterRenderer: public Renderer {
+        private:
+            // Живая клетка - непрозрачный белый пиксель, сетка и мёртвые клетки прозрачны, сквозь них виден фон
+            static constexpr Uint32
+                    PIXEL_ON  = 0xFFFFFFFF,
+                    PIXEL_OFF = 0x00000000;
+
+            static const int BANDS_PER_THREAD = 4; // Больше полос, чем потоков, чтобы потоки заканчивали одновременно
+
+            ThreadPool threadPool; // Свой пул: пул поля занят потоком симуляции
+            vector<Uint32> pixels;
+            Texture texture;
+            Sprite sprite;
+
+            // По чему нарисован pixels
+            uint64_t lastSerial = 0;
+            int lastCellSize = 0, lastWidth = 0, lastHeight = 0;
+
+            /** Рисует строки клеток [startY, endY) */
+            void rasterize(const Snapshot&, int width, int startY, int endY);
+
+        public:
+            /** threadsCount = 0 - по числу логических процессоров */
+            RasterRenderer(unsigned threadsCount = 0);
+
+            virtual void draw(RenderTarget&, const Snapshot&, int width, int height) override;
+    };
+}
+
+#endif // LIFEGAME_RASTER_RENDERER_H
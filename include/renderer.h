@@ -0,0 +1,36 @@
+#ifndef LIFEGAME_RENDERER_H
+#define LIFEGAME_RENDERER_H
+
+#include <string>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "snapshot.h"
+
+namespace lifegame {
+
+    using std::string;
+    using std::vector;
+    using namespace sf;
+
+    /**
+     * Рисует живые клетки снимка. Клетка (x, y) - белый квадрат со стороной CELL_SIZE - 1
+     * в точке (x * CELL_SIZE, y * CELL_SIZE), между клетками остаётся сетка в 1 пиксель
+     */
+    class Renderer {
+        public:
+            static const vector<string> types;
+
+            /**
+             * Создаёт отрисовщик по имени типа ("shape", "vertex", "texture", "incremental", "raster").
+             * Бросает invalid_argument, если тип неизвестен
+             */
+            static Renderer* create(const string& type);
+
+            virtual ~Renderer() {}
+
+            /** Рисует клетки снимка в прямоугольнике [0, width) x [0, height) */
+            virtual void draw(RenderTarget&, const Snapshot&, int width, int height) = 0;
+    };
+}
+
+#endif // LIFEGAME_RENDERER_H
@@ -16,13 +16,24 @@ namespace lifegame {
         const string name;
 
         private:
+        /** Следующее состояние клетки, индекс - (число соседей << 1) | состояние */
+        char table[(MAX_RULE_NUMS + 1) * 2];
+
         static void writeName(string& name, Rule);
         static string nameFor(Rule birth, Rule survive);
 
         public:
         Rules(Rule birth, Rule survive);
 
+        /** Разбирает правила вида "B3/S23" (также "b3/s23" и "B:3 S:23"). Бросает invalid_argument */
+        static Rules parse(const string&);
+
         bool matches(Cell, int neighbours) const;
+
+        /** Следующее состояние клетки без ветвлений. neighbours не больше MAX_RULE_NUMS */
+        inline Cell next(Cell cell, int neighbours) const {
+            return table[neighbours << 1 | (cell.value & CELL_ON)];
+        }
     };
 }
 
@@ -0,0 +1,15 @@
+#ifndef LIFEGAME_SHAPE_RENDERER_H
+#define LIFEGAME_SHAPE_RENDERER_H
+
+#include "renderer.h"
+
+namespace lifegame {
+
+    /** Рисует каждую клетку отдельным вызовом window.draw() (Cell::drawCell) */
+    class ShapeRenderer: public Renderer {
+        public:
+            virtual void draw(RenderTarget&, const Snapshot&, int width, int height) override;
+    };
+}
+
+#endif // LIFEGAME_SHAPE_RENDERER_H
@@ -0,0 +1,25 @@
+#ifndef LIFEGAME_SIMD_H
+#define LIFEGAME_SIMD_H
+
+namespace lifegame {
+
+    enum SimdLevel {
+        SIMD_NONE,
+        SIMD_SSE2,
+        SIMD_AVX2,
+        SIMD_AVX512,
+        SIMD_LEVELS
+    };
+
+    extern const char* const SIMD_LEVEL_NAMES[SIMD_LEVELS];
+
+    /** Наибольший набор инструкций, поддерживаемый процессором (определяется через CPUID) */
+    SimdLevel detectSimdLevel();
+
+    SimdLevel getSimdLevel();
+
+    /** Ограничивает используемый набор инструкций. Уровень выше поддерживаемого понижается */
+    void setSimdLevel(SimdLevel);
+}
+
+#endif // LIFEGAME_SIMD_H
@@ -0,0 +1,97 @@
+#ifndef LIFEGAME_SNAPSHOT_H
+#define LIFEGAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "field.h"
+
+namespace lifegame {
+
+    using std::function;
+    using std::vector;
+
+    /** Снимок видимой части поля и состояния симуляции, который поток симуляции передаёт потоку отрисовки */
+    struct Snapshot {
+        int width = 0, height = 0;
+        vector<char> cells; // cells[x * height + y], 1 - живая клетка
+
+        // Если blockSize не 0, поле показывается уменьшенным: cells пуст,
+        // а density[x * densityHeight() + y] - доля живых клеток в блоке blockSize x blockSize (0..255)
+        int blockSize = 0;
+        vector<uint8_t> density;
+
+        uint64_t serial = 0; // Номер публикации: у разных опубликованных снимков разный
+
+        static constexpr int TILE_SIZE = 16; // Сторона плитки в клетках
+
+        // Плитки (tileX * tilesHeight() + tileY), изменившиеся со снимка dirtySince. Если dirtySince = 0, изменилось всё
+        vector<int> dirtyTiles;
+        uint64_t dirtySince = 0;
+
+        uint64_t generation = 0;
+        uint64_t population = 0; // Живых клеток в снимке, в уменьшенном виде - в области пирамиды плотности
+        int activeTiles = 0, tilesCount = 0; // Участков поля, пересчитанных на последнем шаге, и всего; tilesCount = 0, если поле не разбито
+        uint64_t cyclePeriod = 0, cycleStart = 0; // cyclePeriod = 0, если цикл не найден
+        int jumpProgress = -1; // Процент выполненного перехода к поколению или -1
+
+        inline bool get(int x, int y) const {
+            return cells[(size_t)x * height + y];
+        }
+
+        inline int densityWidth() const {
+            return (width + blockSize - 1) / blockSize;
+        }
+
+        inline int densityHeight() const {
+            return (height + blockSize - 1) / blockSize;
+        }
+
+        inline int tilesWidth() const {
+            return (width + TILE_SIZE - 1) / TILE_SIZE;
+        }
+
+        inline int tilesHeight() const {
+            return (height + TILE_SIZE - 1) / TILE_SIZE;
+        }
+
+        /** Копирует клетки поля из прямоугольника [startX, endX) x [startY, endY) и считает живые. Ограниченное поле обрезает прямоугольник */
+        void capture(const Field&, int startX, int startY, int endX, int endY);
+
+        void forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const;
+
+        void forEachOn(function<void(int, int)> func) const;
+    };
+
+
+    /**
+     * Помнит клетки последнего опубликованного снимка и записывает в следующий снимок,
+     * какие плитки изменились с тех пор
+     */
+    class ChangeTracker {
+            vector<char> cells;
+            int width = 0, height = 0;
+            uint64_t serial = 0;
+
+            // Объединение плиток, изменившихся со снимка baseSerial, который уже есть у читателя
+            vector<char> pendingFlags;
+            vector<int> pendingTiles;
+            uint64_t baseSerial = 0;
+
+        public:
+            /**
+             * Записывает в dirtyTiles плитки cells, изменившиеся с прошлого вызова, и запоминает cells как снимок serial.
+             * Возвращает serial прошлого снимка или 0, если изменилось всё
+             */
+            uint64_t track(const vector<char>& cells, int width, int height, uint64_t serial, vector<int>& dirtyTiles);
+
+            /**
+             * Заполняет snapshot.dirtyTiles плитками, изменившимися со снимка acquiredSerial, который последним получил читатель,
+             * а snapshot.dirtySince - этим снимком. Так пропущенные читателем снимки не заставляют перерисовывать всё.
+             * Вызывается после capture() и назначения serial
+             */
+            void track(Snapshot&, uint64_t acquiredSerial);
+    };
+}
+
+#endif // LIFEGAME_SNAPSHOT_H
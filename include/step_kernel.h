@@ -0,0 +1,29 @@
+#ifndef LIFEGAME_STEP_KERNEL_H
+#define LIFEGAME_STEP_KERNEL_H
+
+#include "cell.h"
+#include "cell_grid.h"
+#include "rules.h"
+#include "check_zone.h"
+#include "simd.h"
+
+namespace lifegame {
+
+    static const int MAX_KERNEL_HEIGHT = 64;
+
+    /**
+     * Записывает прямоугольник [startX, endX) x [startY, endY) следующего поколения из data в nextData
+     * и возвращает, изменилась ли хоть одна клетка. Высота прямоугольника не больше MAX_KERNEL_HEIGHT
+     */
+    typedef bool (*StepKernel)(const CellGrid& data, CellGrid& nextData,
+                               int startX, int startY, int endX, int endY, const Rules&, const CheckZone&);
+
+    /**
+     * Возвращает ядро из реестра, специализированное при компиляции под окрестность,
+     * правила (если они известны заранее) и набор инструкций.
+     * Для неизвестной окрестности возвращается общее ядро с косвенными вызовами
+     */
+    StepKernel stepKernelFor(const CheckZone&, const Rules&, SimdLevel);
+}
+
+#endif // LIFEGAME_STEP_KERNEL_H
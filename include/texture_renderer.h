@@ -0,0 +1,41 @@
+#ifndef LIFEGAME_TEXTURE_RENDERER_H
+#define LIFEGAME_TEXTURE_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+#include "renderer.h"
+
+namespace lifegame {
+
+    using std::vector;
+
+    /**
+     * Рисует поле одной текстурой, в которой каждой клетке соответствует один тексель.
+     * Текстура растягивается в CELL_SIZE раз, а сетку между клетками рисует поверх
+     * повторяющаяся маска размером в одну клетку. Время кадра не зависит от числа живых клеток
+     */
+    class TextureRenderer: public Renderer {
+        private:
+            // Живая клетка - непрозрачный белый тексель, мёртвая - прозрачный, сквозь неё виден фон
+            static constexpr Uint32
+                    TEXEL_ON  = 0xFFFFFFFF,
+                    TEXEL_OFF = 0x00000000;
+
+            vector<Uint32> pixels;
+            Texture cellsTexture, gapTexture;
+            Sprite cellsSprite, gapSprite;
+
+            // По чему построены текстуры
+            uint64_t lastSerial = 0;
+            int lastCellSize = 0, lastWidth = 0, lastHeight = 0;
+
+            void createGap();
+
+            void upload(const Snapshot&, int width, int height);
+
+        public:
+            virtual void draw(RenderTarget&, const Snapshot&, int width, int height) override;
+    };
+}
+
+#endif // LIFEGAME_TEXTURE_RENDERER_H
@@ -0,0 +1,58 @@
+#ifndef LIFEGAME_THREAD_POOL_H
+#define LIFEGAME_THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+namespace lifegame {
+
+    using std::vector;
+    using std::thread;
+    using std::mutex;
+    using std::condition_variable;
+    using std::atomic;
+    using std::function;
+
+    /**
+     * Постоянный пул потоков. Вызывающий поток тоже выполняет задачи,
+     * поэтому пул из одного потока не создаёт дополнительных
+     */
+    class ThreadPool {
+        private:
+            vector<thread> workers;
+
+            mutex mtx;
+            condition_variable startCondition, doneCondition;
+
+            const function<void(int)>* task = nullptr;
+            int tasksCount = 0;
+            atomic<int> nextTask{0};
+            int activeWorkers = 0;
+            uint64_t generation = 0;
+            bool stopping = false;
+
+            void work();
+
+            void workerLoop();
+
+        public:
+            /** threadsCount = 0 - по числу логических процессоров */
+            ThreadPool(unsigned threadsCount = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            unsigned getThreadsCount() const;
+
+            /** Выполняет task(i) для всех i из [0, count) и ждёт завершения всех задач */
+            void run(int count, const function<void(int)>& task);
+    };
+}
+
+#endif // LIFEGAME_THREAD_POOL_H
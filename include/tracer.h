@@ -0,0 +1,107 @@
+#ifndef LIFEGAME_TRACER_H
+#define LIFEGAME_TRACER_H
+
+/*
+ * Запись временной шкалы в формате Chrome trace event (chrome://tracing, ui.perfetto.dev).
+ * Включается макросом TRACE (-DTRACE), без него TRACE_SCOPE ничего не делает, а классы не объявляются
+ */
+
+#ifdef TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lifegame {
+
+    using std::string;
+
+    /**
+     * Каждый поток пишет события в собственный кольцевой буфер без блокировок,
+     * старые события перезаписываются. Мьютекс берётся только при первом событии потока.
+     * Буфер читается как seqlock: dump() отбрасывает события, которые перезаписывались, пока он их копировал
+     */
+    class Tracer {
+        public:
+            static const int EVENTS_PER_THREAD = 1 << 16;
+
+            /** Куда записывает dump() */
+            static string path;
+
+        private:
+            struct Event {
+                std::atomic<const char*> name; // Строковый литерал
+                std::atomic<int64_t> start, duration; // В наносекундах от запуска программы
+            };
+
+            struct ThreadBuffer {
+                Event events[EVENTS_PER_THREAD];
+                std::atomic<uint64_t> count{0}; // Число записанных событий
+                std::atomic<uint64_t> started{0}; // Число начатых записей, обгоняет count во время записи
+                const char* name = nullptr;
+                int id;
+            };
+
+            // Буферы не удаляются, чтобы события завершившихся потоков попали в dump()
+            static std::mutex buffersMutex;
+            static std::vector<ThreadBuffer*> buffers;
+
+            static ThreadBuffer& threadBuffer();
+
+        public:
+            static int64_t now();
+
+            /** Событие длительностью от start до текущего момента */
+            static inline void add(const char* name, int64_t start) {
+                ThreadBuffer& buffer = threadBuffer();
+                const uint64_t count = buffer.count.load(std::memory_order_relaxed);
+                const int64_t duration = now() - start;
+                Event& event = buffer.events[count % EVENTS_PER_THREAD];
+
+                buffer.started.store(count + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                event.name.store(name, std::memory_order_relaxed);
+                event.start.store(start, std::memory_order_relaxed);
+                event.duration.store(duration, std::memory_order_relaxed);
+
+                buffer.count.store(count + 1, std::memory_order_release);
+            }
+
+            /** Имя текущего потока на временной шкале */
+            static void setThreadName(const char*);
+
+            /**
+             * Записывает события всех потоков в path. События, которые потоки перезаписали во время копирования,
+             * отбрасываются, поэтому вызывать стоит, когда пул потоков простаивает
+             */
+            static void dump();
+    };
+
+    /** Записывает событие от создания до уничтожения объекта */
+    class TraceScope {
+            const char* const name;
+            const int64_t start;
+
+        public:
+            inline TraceScope(const char* name):
+                    name(name), start(Tracer::now()) {}
+
+            inline ~TraceScope() {
+                Tracer::add(name, start);
+            }
+    };
+}
+
+#define TRACE_SCOPE(name) TraceScope traceScope(name)
+
+#else
+
+#define TRACE_SCOPE(name)
+
+#endif // TRACE
+
+#endif // LIFEGAME_TRACER_H
@@ -0,0 +1,49 @@
+#ifndef LIFEGAME_TRIPLE_BUFFER_H
+#define LIFEGAME_TRIPLE_BUFFER_H
+
+#include <atomic>
+
+namespace lifegame {
+
+    /**
+     * Тройной буфер без блокировок для одного писателя и одного читателя.
+     * Писатель заполняет getBack() и публикует его, меняя местами со средним буфером,
+     * читатель забирает средний буфер, если в нём есть новые данные. Ни одна сторона не ждёт другую,
+     * неполученные читателем данные перезаписываются
+     */
+    template<typename T>
+    class TripleBuffer {
+            static const int FRESH = 4; // Бит в middle: средний буфер опубликован и ещё не прочитан
+
+            T buffers[3];
+            int back = 0, front = 1;
+            std::atomic<int> middle{2};
+
+        public:
+            /** Буфер писателя */
+            inline T& getBack() {
+                return buffers[back];
+            }
+
+            /** Буфер читателя: последние полученные данные */
+            inline const T& getFront() const {
+                return buffers[front];
+            }
+
+            /** Вызывается писателем после заполнения getBack() */
+            inline void publish() {
+                back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+            }
+
+            /** Вызывается читателем. Возвращает, появились ли в getFront() новые данные */
+            inline bool acquire() {
+                if((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+                    return false;
+
+                front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+                return true;
+            }
+    };
+}
+
+#endif // LIFEGAME_TRIPLE_BUFFER_H
@@ -0,0 +1,28 @@
+#ifndef LIFEGAME_VERTEX_RENDERER_H
+#define LIFEGAME_VERTEX_RENDERER_H
+
+#include <cstdint>
+#include "renderer.h"
+
+namespace lifegame {
+
+    /**
+     * Собирает все клетки в один массив четырёхугольников и рисует его одним вызовом.
+     * Массив переиспользуется между кадрами и перестраивается, только когда сменился снимок или масштаб
+     */
+    class VertexRenderer: public Renderer {
+        private:
+            VertexArray quads{Quads};
+
+            // По чему построен quads
+            uint64_t lastSerial = 0;
+            int lastCellSize = 0, lastWidth = 0, lastHeight = 0;
+
+            void build(const Snapshot&, int width, int height);
+
+        public:
+            virtual void draw(RenderTarget&, const Snapshot&, int width, int height) override;
+    };
+}
+
+#endif // LIFEGAME_VERTEX_RENDERER_H
@@ -1,4 +1,7 @@
 #include "life_game.h"
+#include "hash_life_field.h"
+#include "tracer.h"
+#include <cstdio>
 #include <iostream>
 
 int main(int argc, const char* args[]) {
@@ -7,40 +10,127 @@ int main(int argc, const char* args[]) {
     using std::cerr;
     using std::endl;
     using std::exception;
+    using std::string;
 
-    srand(time(nullptr));
+    string fieldType = "cell", rendererType = "incremental";
+    unsigned threadsCount = 0;
+    int fieldWidth = 0, fieldHeight = 0;
+    Topology topology = TOPOLOGY_PLANE;
+    CycleAction cycleAction = CYCLE_OFF;
 
-    try {
-        LifeGame game(VideoMode::getFullscreenModes()[0]);
+    for(int i = 1; i < argc; ++i) {
+        const string arg = args[i];
 
-        #if 1
-        game.fillRandom();
-        game.run();
-        #else
+        if((arg == "-f" || arg == "--field") && i + 1 < argc) {
+            fieldType = args[++i];
 
-        game.incScale(-2);
-        game.fillRandom();
-        game.setDelay(16ms);
+        } else if(arg == "--size" && i + 1 < argc) {
+            if(sscanf(args[++i], "%dx%d", &fieldWidth, &fieldHeight) != 2 || fieldWidth <= 0 || fieldHeight <= 0) {
+                cerr << "Invalid size \"" << args[i] << "\"" << endl;
+                return 1;
+            }
+
+        } else if((arg == "-r" || arg == "--renderer") && i + 1 < argc) {
+            rendererType = args[++i];
+
+        } else if((arg == "-t" || arg == "--threads") && i + 1 < argc) {
+            threadsCount = atoi(args[++i]);
+
+        } else if(arg == "--memory" && i + 1 < argc) {
+            HashLifeField::defaultMemoryLimit = (size_t)atol(args[++i]) << 20;
+
+        } else if(arg == "--simd" && i + 1 < argc) {
+            const string level = args[++i];
+            int index = 0;
+
+            while(index < SIMD_LEVELS && level != SIMD_LEVEL_NAMES[index])
+                ++index;
+
+            if(index == SIMD_LEVELS) {
+                cerr << "Unknown SIMD level \"" << level << "\"" << endl;
+                return 1;
+            }
+
+            setSimdLevel((SimdLevel)index);
+
+        } else if(arg == "--topology" && i + 1 < argc) {
+            const string name = args[++i];
+            int index = 0;
+
+            while(index < TOPOLOGIES && name != TOPOLOGY_NAMES[index])
+                ++index;
+
+            if(index == TOPOLOGIES) {
+                cerr << "Unknown topology \"" << name << "\"" << endl;
+                return 1;
+            }
+
+            topology = (Topology)index;
+
+        } else if(arg == "--on-cycle" && i + 1 < argc) {
+            const string name = args[++i];
+            int index = 0;
+
+            while(index < CYCLE_ACTIONS && name != CYCLE_ACTION_NAMES[index])
+                ++index;
 
-        uint64_t tolalTicks = 0;
-        uint32_t tolalSteps = 0;
+            if(index == CYCLE_ACTIONS) {
+                cerr << "Unknown cycle action \"" << name << "\"" << endl;
+                return 1;
+            }
 
-        for(int i = 0; i < 100; ++i) {
-            uint64_t start = rdtsc();
+            cycleAction = (CycleAction)index;
 
-            game.step();
+        #ifdef TRACE
+        } else if(arg == "--trace" && i + 1 < argc) {
+            Tracer::path = args[++i];
+        #endif // TRACE
 
-            uint64_t elapsed = rdtsc() - start;
-            //cout << "elapsed: " << elapsed << " (" << elapsed / (1024.f * 1024.f) << " M)" << endl;
-            tolalTicks += elapsed;
-            ++tolalSteps;
+        } else {
+            cerr << "Usage: " << args[0] << " [--field <type>] [--size <width>x<height>] [--renderer <type>] [--threads <count>] [--memory <MB>] [--simd <level>] [--topology <name>] [--on-cycle <action>]" << endl;
+            cerr << "Field types:";
+
+            for(const string& type : Field::types)
+                cerr << ' ' << type;
+
+            cerr << endl << "Renderers:";
+
+            for(const string& type : Renderer::types)
+                cerr << ' ' << type;
+
+            cerr << endl << "SIMD levels:";
+
+            for(const char* level : SIMD_LEVEL_NAMES)
+                cerr << ' ' << level;
+
+            cerr << endl << "Topologies:";
+
+            for(const char* name : TOPOLOGY_NAMES)
+                cerr << ' ' << name;
+
+            cerr << endl << "Cycle actions:";
+
+            for(const char* name : CYCLE_ACTION_NAMES)
+                cerr << ' ' << name;
+
+            cerr << endl;
+            return 1;
         }
+    }
 
-        uint64_t average = tolalTicks / tolalSteps;
-        cout << "average: " << average << " (" << average / (1024.f * 1024.f) << " M)" << endl;
-        getchar();
+    srand(time(nullptr));
+
+    try {
+        LifeGame game(VideoMode::getFullscreenModes()[0], false, "sans-serif.ttf", fieldType, threadsCount, rendererType);
 
-        #endif // 0
+        if(fieldWidth != 0)
+            game.setFieldSize(fieldWidth, fieldHeight);
+
+        game.setTopology(topology);
+        game.setCycleAction(cycleAction);
+
+        game.fillRandom();
+        game.run();
 
     } catch(exception& ex) {
         cerr << ex.what() << endl;
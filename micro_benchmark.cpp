@@ -0,0 +1,295 @@
+#include "cell_field.h"
+#include "check_zone.h"
+#include "rules.h"
+#include "simd.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace lifegame {
+
+    using std::function;
+    using std::string;
+    using std::vector;
+
+    /** Открывает защищённые методы CellField для замеров */
+    class BenchmarkCellField: public CellField {
+        public:
+            BenchmarkCellField(int width, int height):
+                CellField(width, height) {}
+
+            using CellField::forEachCell;
+
+            void grow(int width, int height) {
+                this->width = width;
+                this->height = height;
+                extendDataIfNecessary();
+            }
+    };
+
+    /**
+     * Запускает замер, пока суммарное время не превысит minSeconds.
+     * setup выполняется перед каждой итерацией и в замер не входит
+     */
+    class MicroBenchmark {
+        public:
+            double minSeconds = 0.2;
+            string filter;
+            bool json = false;
+
+            volatile int sink = 0; // Не даёт компилятору выбросить результаты
+
+        private:
+            using clock = std::chrono::steady_clock;
+
+        public:
+            void run(const string& name, int width, int height, function<void()> body, function<void()> setup = nullptr) {
+                if(!filter.empty() && name.find(filter) == string::npos)
+                    return;
+
+                double total = 0, best = 0;
+                int iterations = 0;
+
+                do {
+                    if(setup)
+                        setup();
+
+                    const clock::time_point start = clock::now();
+                    body();
+                    const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+
+                    best = iterations == 0 ? elapsed : std::min(best, elapsed);
+                    total += elapsed;
+                    ++iterations;
+
+                } while(total < minSeconds);
+
+                const double
+                        cells = (double)width * height,
+                        bestNs = best * 1e9 / cells,
+                        meanNs = total * 1e9 / iterations / cells;
+
+                if(json) {
+                    cout << "{\"name\": \"" << name << "\", \"width\": " << width << ", \"height\": " << height
+                         << ", \"iterations\": " << iterations << ", \"nsPerCell\": " << bestNs
+                         << ", \"meanNsPerCell\": " << meanNs << "}" << endl;
+                } else {
+                    printf("%-32s %6dx%-6d %10.3f ns/cell %10.3f mean %10.1f Mcells/s %6d it\n",
+                           name.c_str(), width, height, bestNs, meanNs, cells / best / 1e6, iterations);
+                }
+            }
+    };
+}
+
+/**
+ * Замеры отдельных слоёв: подсчёт соседей, правила, обход клеток, заполнение,
+ * выделение памяти, расширение поля и рисование линии мышью.
+ * Каждый замер повторяется для полей от помещающихся в L1 до не помещающихся в кеш
+ */
+int main(int argc, const char* args[]) {
+    using namespace lifegame;
+    using std::cerr;
+    using std::exception;
+
+    MicroBenchmark benchmark;
+
+    // 4 КБ и 16 КБ клеток помещаются в L1, 256 КБ - в L2, 4 МБ - в L3, 64 МБ - только в памяти
+    vector<std::pair<int, int>> sizes { {64, 64}, {128, 128}, {512, 512}, {2048, 2048}, {8192, 8192} };
+
+    for(int i = 1; i < argc; ++i) {
+        const string arg = args[i];
+
+        if(arg == "--sizes" && i + 1 < argc) {
+            sizes.clear();
+
+            for(const char* str = args[++i]; *str != '\0'; ) {
+                int width, height, length;
+
+                if(sscanf(str, "%dx%d%n", &width, &height, &length) != 2 || width <= 0 || height <= 0) {
+                    cerr << "Invalid sizes \"" << args[i] << "\"" << endl;
+                    return 1;
+                }
+
+                sizes.emplace_back(width, height);
+                str += length;
+
+                if(*str == ',')
+                    ++str;
+            }
+
+        } else if(arg == "--filter" && i + 1 < argc) {
+            benchmark.filter = args[++i];
+
+        } else if(arg == "--min-time" && i + 1 < argc) {
+            benchmark.minSeconds = atoi(args[++i]) / 1000.0;
+
+        } else if(arg == "--json") {
+            benchmark.json = true;
+
+        } else {
+            cerr << "Usage: " << args[0] << " [--sizes <width>x<height>,...] [--filter <substring>] [--min-time <ms>] [--json]" << endl;
+            return 1;
+        }
+    }
+
+    try {
+        const Rules rules = Rules::parse("B3/S23");
+        const SimdLevel maxSimdLevel = getSimdLevel();
+
+        for(const auto& size : sizes) {
+            const int width = size.first, height = size.second;
+
+            BenchmarkCellField field(width, height);
+            field.fillRandom();
+
+            CellGrid grid(width, height);
+            vector<uint8_t> counts((size_t)width * height);
+
+            field.forEachOn([&grid] (int x, int y) { grid[x][y] = CELL_ON; });
+
+
+            for(const CheckZone* zone : CheckZone::checkZones) {
+                benchmark.run("countNeighbours/" + zone->name, width, height, [&] () {
+                    int sum = 0;
+
+                    for(int x = 0; x < width; ++x) {
+                        for(int y = 0; y < height; ++y) {
+                            sum += zone->countNeighbours(grid[x - 1] + y, grid[x] + y, grid[x + 1] + y);
+                        }
+                    }
+
+                    benchmark.sink = sum;
+                });
+
+                for(int level = 0; level <= maxSimdLevel; ++level) {
+                    setSimdLevel((SimdLevel)level);
+
+                    benchmark.run("countColumn/" + zone->name + "/" + SIMD_LEVEL_NAMES[level], width, height, [&] () {
+                        for(int x = 0; x < width; ++x) {
+                            zone->countColumn(grid[x - 1], grid[x], grid[x + 1], &counts[(size_t)x * height], height);
+                        }
+
+                        benchmark.sink = counts[0];
+                    });
+                }
+
+                setSimdLevel(maxSimdLevel);
+            }
+
+
+            for(int x = 0; x < width; ++x) {
+                CheckZone::QUAD.countColumn(grid[x - 1], grid[x], grid[x + 1], &counts[(size_t)x * height], height);
+            }
+
+            benchmark.run("Rules::matches", width, height, [&] () {
+                int sum = 0;
+
+                for(int x = 0; x < width; ++x) {
+                    const Cell* const column = grid[x];
+                    const uint8_t* const columnCounts = &counts[(size_t)x * height];
+
+                    for(int y = 0; y < height; ++y) {
+                        sum += rules.matches(column[y], columnCounts[y]);
+                    }
+                }
+
+                benchmark.sink = sum;
+            });
+
+            benchmark.run("Rules::next", width, height, [&] () {
+                int sum = 0;
+
+                for(int x = 0; x < width; ++x) {
+                    const Cell* const column = grid[x];
+                    const uint8_t* const columnCounts = &counts[(size_t)x * height];
+
+                    for(int y = 0; y < height; ++y) {
+                        sum += rules.next(column[y], columnCounts[y]).value;
+                    }
+                }
+
+                benchmark.sink = sum;
+            });
+
+
+            benchmark.run("forEachCell", width, height, [&] () {
+                int sum = 0;
+
+                field.forEachCell([&sum] (int, int, Cell& cell) {
+                    sum += cell.value;
+                });
+
+                benchmark.sink = sum;
+            });
+
+            benchmark.run("forEachOn", width, height, [&] () {
+                int sum = 0;
+
+                field.forEachOn([&sum] (int x, int y) {
+                    sum += x ^ y;
+                });
+
+                benchmark.sink = sum;
+            });
+
+            benchmark.run("fillRandom", width, height, [&] () { field.fillRandom(); });
+            benchmark.run("clear",      width, height, [&] () { field.clear(); });
+            benchmark.run("fill",       width, height, [&] () { field.fill(); });
+
+
+            benchmark.run("new_2d_array", width, height, [&] () {
+                Cell** const array = new_2d_array<Cell>(width + 2, height + 2, 1, CELL_OFF);
+                benchmark.sink = array[width - 1][height - 1].value;
+                delete[] static_cast<char*>(static_cast<void*>(array - 1));
+            });
+
+            benchmark.run("CellGrid", width, height, [&] () {
+                CellGrid grid(width, height);
+                benchmark.sink = grid[width - 1][height - 1].value;
+            });
+
+            BenchmarkCellField* halfField = nullptr;
+
+            benchmark.run("extendDataIfNecessary", width, height,
+                [&] () {
+                    halfField->grow(width, height);
+                },
+                [&] () {
+                    delete halfField;
+                    halfField = new BenchmarkCellField((width + 1) / 2, (height + 1) / 2);
+                }
+            );
+
+            delete halfField;
+
+
+            // Линия по диагонали поля: перебирается ограничивающий её прямоугольник, как при рисовании мышью.
+            // Наименьший размер клетки, чтобы координаты больших полей не переполняли int в Cell::sign
+            CELL_SIZE = MIN_CELL_SIZE;
+
+            benchmark.run("Cell::intersectsWith", width, height, [&] () {
+                const Vector2i startPoint(0, 0), endPoint(width * CELL_SIZE - 1, height * CELL_SIZE - 1);
+                int sum = 0;
+
+                for(int x = 0; x < width; ++x) {
+                    for(int y = 0; y < height; ++y) {
+                        sum += Cell::intersectsWith(startPoint, endPoint, x, y);
+                    }
+                }
+
+                benchmark.sink = sum;
+            });
+        }
+
+    } catch(exception& ex) {
+        cerr << ex.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
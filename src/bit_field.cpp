@@ -0,0 +1,325 @@
+#ifndef LIFEGAME_BIT_FIELD_CPP
+#define LIFEGAME_BIT_FIELD_CPP
+
+#include <algorithm>
+#include <utility>
+#include "bit_field.h"
+#include "bit_rules.h"
+
+namespace lifegame {
+
+    using std::copy;
+    using std::swap;
+    using std::min;
+    using std::max;
+
+    int BitField::wordsFor(int height) {
+        return (height + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    void BitField::resetUntakenTiles() {
+        untakenTiles.assign((size_t)wordsFor(width) * wordsFor(height), true);
+    }
+
+    BitField::word_t BitField::wordMask(int i, int height) {
+        int bits = height - i * WORD_BITS;
+        return bits >= WORD_BITS ? ~(word_t)0 : bits <= 0 ? 0 : ((word_t)1 << bits) - 1;
+    }
+
+    BitField::BitField(int width, int height):
+            Field(width, height),
+            dataWidth(width), dataHeight(height),
+            stride(wordsFor(height) + 2),
+            front(new word_t[(width + 2) * stride]()), // Резервируем пустые столбцы слева и справа
+            back(new word_t[(width + 2) * stride]()) {
+
+        resetUntakenTiles();
+    }
+
+    BitField::~BitField() {
+        delete[] front;
+        delete[] back;
+    }
+
+    bool BitField::get(int x, int y) const {
+        return (column(front, x)[y / WORD_BITS] >> (y % WORD_BITS)) & 1;
+    }
+
+    void BitField::set(int x, int y, bool on) {
+        word_t& word = column(front, x)[y / WORD_BITS];
+        const word_t bit = (word_t)1 << (y % WORD_BITS);
+
+        word = on ? word | bit : word & ~bit;
+        untakenTiles[(size_t)(x / WORD_BITS) * wordsFor(height) + y / WORD_BITS] = true;
+    }
+
+    void BitField::resize(int width, int height) {
+        // При замкнутой топологии рамка старого размера может оказаться внутри поля
+        if(topology != TOPOLOGY_PLANE)
+            clearOutside();
+
+        this->width = width;
+        this->height = height;
+
+        if(width > dataWidth || height > dataHeight) {
+            const int newDataWidth = max(width, dataWidth),
+                      newDataHeight = max(height, dataHeight),
+                      newStride = wordsFor(newDataHeight) + 2;
+
+            word_t *const newFront = new word_t[(newDataWidth + 2) * newStride]();
+
+            for(int x = 0; x < dataWidth; ++x) {
+                copy(column(front, x), column(front, x) + stride - 2, newFront + (x + 1) * newStride + 1);
+            }
+
+            delete[] front;
+            delete[] back;
+
+            front = newFront;
+            back = new word_t[(newDataWidth + 2) * newStride];
+            dataWidth = newDataWidth;
+            dataHeight = newDataHeight;
+            stride = newStride;
+        }
+
+        if(topology != TOPOLOGY_PLANE)
+            clearOutside();
+
+        // step() пишет в back только видимую часть, остальное должно совпадать с front
+        copy(front, front + (dataWidth + 2) * stride, back);
+
+        resetUntakenTiles();
+    }
+
+    bool BitField::supportsTopology(Topology) const {
+        return true;
+    }
+
+    void BitField::setTopology(Topology topology) {
+        const Topology oldTopology = this->topology;
+        Field::setTopology(topology);
+
+        if(oldTopology != TOPOLOGY_PLANE || topology != TOPOLOGY_PLANE) {
+            clearOutside();
+            copy(front, front + (dataWidth + 2) * stride, back);
+        }
+    }
+
+    void BitField::clearOutside() {
+        for(int x = -1; x <= dataWidth; ++x) {
+            word_t* const col = column(front, x);
+
+            if(x < 0 || x >= width) {
+                std::fill(col - 1, col - 1 + stride, 0);
+            } else {
+                col[-1] = 0;
+
+                for(int i = 0; i < stride - 1; ++i) {
+                    col[i] &= wordMask(i, height);
+                }
+            }
+        }
+    }
+
+    void BitField::updateBorder() {
+        if((topology != TOPOLOGY_TORUS && topology != TOPOLOGY_KLEIN) || width == 0 || height == 0)
+            return;
+
+        const int width = this->width, height = this->height;
+
+        // Верхний и нижний края склеены в обеих топологиях: бит 63 слова -1 - строка -1, бит height - строка height
+        const word_t bottomBit = (word_t)1 << (height % WORD_BITS);
+
+        for(int x = 0; x < width; ++x) {
+            word_t* const col = column(front, x);
+            word_t& bottom = col[height / WORD_BITS];
+
+            col[-1] = ((col[(height - 1) / WORD_BITS] >> ((height - 1) % WORD_BITS)) & 1) << (WORD_BITS - 1);
+            bottom = (col[0] & 1) ? bottom | bottomBit : bottom & ~bottomBit;
+        }
+
+        const word_t *const first = column(front, 0) - 1, *const last = column(front, width - 1) - 1;
+        word_t *const left = column(front, -1) - 1, *const right = column(front, width) - 1;
+
+        if(topology == TOPOLOGY_TORUS) {
+            copy(last, last + stride, left);
+            copy(first, first + stride, right);
+            return;
+        }
+
+        // Бутылка Клейна: крайние столбцы переворачиваются по вертикали, строки -1 и height тоже
+        std::fill(left, left + stride, 0);
+        std::fill(right, right + stride, 0);
+
+        for(int y = -1; y <= height; ++y) {
+            // Индексы бит относительно начала слова -1 (в нём строки -64..-1): строка y переходит в height - 1 - y
+            const int from = height - 1 - y + WORD_BITS, to = y + WORD_BITS;
+
+            left[to / WORD_BITS] |= ((last[from / WORD_BITS] >> (from % WORD_BITS)) & 1) << (to % WORD_BITS);
+            right[to / WORD_BITS] |= ((first[from / WORD_BITS] >> (from % WORD_BITS)) & 1) << (to % WORD_BITS);
+        }
+    }
+
+    void BitField::step(const Rules& rules, const CheckZone& checkZone) {
+        updateBorder();
+
+        const BitRules bitRules(rules, checkZone);
+
+        const int words = wordsFor(height);
+        const word_t lastMask = wordMask(words - 1, height);
+
+        // Столбцы разбиваются на полосы из целых участков; каждая полоса пишет только в свои столбцы back и свои участки
+        const int tilesWidth = wordsFor(width),
+                  bands = bandsFor(tilesWidth);
+
+        parallelFor(bands, [&] (int band) {
+            const int startX = (int64_t)tilesWidth * band / bands * WORD_BITS,
+                      endX = min((int64_t)tilesWidth * (band + 1) / bands * WORD_BITS, (int64_t)width);
+
+            for(int x = startX; x < endX; ++x) {
+                const word_t* const columns[3] = { column(front, x - 1), column(front, x), column(front, x + 1) };
+                word_t* const result = column(back, x);
+                char* const changed = &untakenTiles[(size_t)(x / WORD_BITS) * words];
+
+                for(int i = 0; i < words; ++i) {
+                    const word_t
+                        above[3] = { columns[0][i - 1], columns[1][i - 1], columns[2][i - 1] },
+                        cells[3] = { columns[0][i],     columns[1][i],     columns[2][i]     },
+                        below[3] = { columns[0][i + 1], columns[1][i + 1], columns[2][i + 1] };
+
+                    word_t next = bitRules.next(above, cells, below);
+
+                    if(i == words - 1) {
+                        next = (next & lastMask) | (cells[1] & ~lastMask);
+                    }
+
+                    result[i] = next;
+                    changed[i] |= next != cells[1];
+                }
+            }
+        });
+
+        swap(front, back);
+    }
+
+    void BitField::fillWith(bool on) {
+        const int words = wordsFor(height);
+
+        for(int x = 0; x < width; ++x) {
+            word_t* const col = column(front, x);
+
+            for(int i = 0; i < words; ++i) {
+                const word_t mask = wordMask(i, height);
+                col[i] = on ? col[i] | mask : col[i] & ~mask;
+            }
+        }
+
+        resetUntakenTiles();
+    }
+
+    void BitField::clear() {
+        fillWith(false);
+    }
+
+    void BitField::fill() {
+        fillWith(true);
+    }
+
+    void BitField::forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const {
+        if(startY >= endY)
+            return;
+
+        const int startWord = startY / WORD_BITS,
+                  endWord = (endY - 1) / WORD_BITS;
+
+        for(int x = startX; x < endX; ++x) {
+            const word_t* const col = column(front, x);
+
+            for(int i = startWord; i <= endWord; ++i) {
+                word_t word = col[i] & wordMask(i, endY) & ~wordMask(i, startY);
+
+                while(word != 0) {
+                    func(x, i * WORD_BITS + __builtin_ctzll(word));
+                    word &= word - 1;
+                }
+            }
+        }
+    }
+
+    uint64_t BitField::hash() {
+        const int words = wordsFor(height);
+        const word_t lastMask = wordMask(words - 1, height);
+        uint64_t hash = 0;
+
+        if(words == 0)
+            return hash;
+
+        for(int x = 0; x < width; ++x) {
+            const word_t* const col = column(front, x);
+
+            for(int i = 0; i < words - 1; ++i) {
+                hash = hashWord(hash, col[i]);
+            }
+
+            hash = hashWord(hash, col[words - 1] & lastMask);
+        }
+
+        return mixHash(hash);
+    }
+
+    int BitField::getChangedTileSize() const {
+        return WORD_BITS;
+    }
+
+    bool BitField::takeChangedTiles(vector<Tile>& tiles) {
+        const int tilesHeight = wordsFor(height);
+
+        tiles.clear();
+
+        for(size_t tile = 0; tile < untakenTiles.size(); ++tile) {
+            if(untakenTiles[tile]) {
+                tiles.push_back({ (int)(tile / tilesHeight), (int)(tile % tilesHeight) });
+                untakenTiles[tile] = false;
+            }
+        }
+
+        return true;
+    }
+
+    uint32_t BitField::countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const {
+        endX = min(endX, width);
+        endY = min(endY, height);
+
+        if(startX >= endX || startY >= endY)
+            return 0;
+
+        const int startWord = max(startY, 0) / WORD_BITS,
+                  endWord = (endY - 1) / WORD_BITS;
+
+        uint32_t count = 0;
+
+        for(int x = max(startX, 0); x < endX; x += 2) {
+            const word_t *const left = column(front, x), *const right = column(front, x + 1);
+            uint8_t* const blocks = counts + (size_t)((x - startX) / 2) * countsHeight;
+
+            for(int i = startWord; i <= endWord; ++i) {
+                const word_t mask = wordMask(i, endY) & ~wordMask(i, startY),
+                             leftWord = left[i] & mask,
+                             rightWord = x + 1 < endX ? right[i] & mask : 0;
+
+                if((leftWord | rightWord) == 0)
+                    continue;
+
+                // Слово сдвигается так, чтобы бит 0 был не выше startY; startY чётный, поэтому блоки не разрываются
+                const int shift = max(startY - i * WORD_BITS, 0);
+
+                countWordBlocks(leftWord >> shift, rightWord >> shift, blocks + (i * WORD_BITS + shift - startY) / 2);
+                count += __builtin_popcountll(leftWord) + __builtin_popcountll(rightWord);
+            }
+        }
+
+        return count;
+    }
+}
+
+#endif // LIFEGAME_BIT_FIELD_CPP
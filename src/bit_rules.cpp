@@ -0,0 +1,26 @@
+#ifndef LIFEGAME_BIT_RULES_CPP
+#define LIFEGAME_BIT_RULES_CPP
+
+#include "bit_rules.h"
+
+namespace lifegame {
+
+    BitRules::BitRules(const Rules& rules, const CheckZone& checkZone) {
+        for(int dx = -1; dx <= 1; ++dx) {
+            for(int dy = -1; dy <= 1; ++dy) {
+                if(checkZone.includes(dx, dy))
+                    planes[planesCount++] = (dx + 1) * 3 + (dy + 1);
+            }
+        }
+
+        for(int n = 0; n <= MAX_RULE_NUMS; ++n) {
+            birth[n] = rules.birth.matches(n);
+            survive[n] = rules.survive.matches(n);
+
+            if(birth[n] || survive[n])
+                counts[countsNumber++] = n;
+        }
+    }
+}
+
+#endif // LIFEGAME_BIT_RULES_CPP
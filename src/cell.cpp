@@ -18,32 +18,18 @@ namespace lifegame {
     }
 
 
-    void Cell::draw(RenderWindow& window, int x, int y) const {
+    void Cell::draw(RenderTarget& window, int x, int y) const {
         RectangleShape& cellShape = isOn() ? whiteCellShape : blackCellShape;
         cellShape.setPosition(x * CELL_SIZE, y * CELL_SIZE);
         window.draw(cellShape);
     }
 
-    void Cell::drawCell(RenderWindow& window, int x, int y) {
+    void Cell::drawCell(RenderTarget& window, int x, int y) {
         whiteCellShape.setPosition(x * CELL_SIZE, y * CELL_SIZE);
         window.draw(whiteCellShape);
     }
 
-    #ifdef DRAW_PARALLEL
-    void Cell::drawCellSynchronized(RenderWindow& window, int x, int y, mutex& mtx) {
-
-        RectangleShape cellShape(Vector2f(CELL_SIZE - 1, CELL_SIZE - 1));
-
-        cellShape.setPosition(x * CELL_SIZE, y * CELL_SIZE);
-        cellShape.setFillColor(Color::White);
-
-        mtx.lock();
-        window.draw(cellShape);
-        mtx.unlock();
-    }
-    #endif // DRAW_PARALLEL
-
-    bool Cell::intersectsWith(Vector2i startPoint, Vector2i endPoint, int x, int y) const {
+    bool Cell::intersectsWith(Vector2i startPoint, Vector2i endPoint, int x, int y) {
         x *= CELL_SIZE;
         y *= CELL_SIZE;
 
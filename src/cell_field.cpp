@@ -0,0 +1,449 @@
+#ifndef LIFEGAME_CELL_FIELD_CPP
+#define LIFEGAME_CELL_FIELD_CPP
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include "cell_field.h"
+
+namespace lifegame {
+
+    using std::max;
+    using std::min;
+    using std::copy;
+    using std::reverse_copy;
+
+    CellField::CellField(int width, int height):
+            Field(width, height),
+            dataWidth(width), dataHeight(height),
+            data(width, height),
+            nextData(width, height) {
+
+        resetTiles();
+    }
+
+    CellField::~CellField() {}
+
+    bool CellField::get(int x, int y) const {
+        return data[x][y].isOn();
+    }
+
+    void CellField::set(int x, int y, bool on) {
+        data[x][y] = on ? CELL_ON : CELL_OFF;
+        markChanged(x, y);
+    }
+
+    void CellField::resize(int width, int height) {
+        // При замкнутой топологии рамка старого размера может оказаться внутри поля
+        if(topology != TOPOLOGY_PLANE)
+            clearOutside();
+
+        this->width = width;
+        this->height = height;
+        extendDataIfNecessary();
+
+        if(topology != TOPOLOGY_PLANE)
+            clearOutside();
+
+        // step() пишет в nextData только видимую часть, остальное должно совпадать с data
+        copyData(data, nextData);
+        resetTiles();
+    }
+
+    bool CellField::supportsTopology(Topology) const {
+        return true;
+    }
+
+    void CellField::setTopology(Topology topology) {
+        const Topology oldTopology = this->topology;
+        Field::setTopology(topology);
+
+        if(oldTopology != TOPOLOGY_PLANE || topology != TOPOLOGY_PLANE) {
+            clearOutside();
+            copyData(data, nextData);
+        }
+
+        resetTiles();
+    }
+
+    void CellField::resetTiles() {
+        tilesWidth = (width + TILE_SIZE - 1) / TILE_SIZE;
+        tilesHeight = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+        changedTiles.assign(tilesWidth * tilesHeight, true);
+        activeTiles.assign(tilesWidth * tilesHeight, true);
+        tileHashes.assign(tilesWidth * tilesHeight, 0);
+        dirtyHashes.assign(tilesWidth * tilesHeight, true);
+        untakenTiles.assign(tilesWidth * tilesHeight, true);
+    }
+
+    uint64_t CellField::hashTile(int tileX, int tileY) const {
+        const int
+                startX = tileX * TILE_SIZE, endX = min(startX + TILE_SIZE, width),
+                startY = tileY * TILE_SIZE, endY = min(startY + TILE_SIZE, height);
+
+        uint64_t hash = 0;
+
+        for(int x = startX; x < endX; ++x) {
+            const Cell* const column = data[x];
+            int y = startY;
+
+            for(; y + 8 <= endY; y += 8) {
+                uint64_t word;
+                memcpy(&word, column + y, sizeof(word));
+                hash = hashWord(hash, word);
+            }
+
+            for(; y < endY; ++y) {
+                hash = hashWord(hash, column[y].value);
+            }
+        }
+
+        return hash;
+    }
+
+    uint64_t CellField::hash() {
+        const int tilesCount = tilesWidth * tilesHeight,
+                  bands = bandsFor(tilesCount);
+
+        parallelFor(bands, [this, tilesCount, bands] (int band) {
+            for(int tile = (int64_t)tilesCount * band / bands, end = (int64_t)tilesCount * (band + 1) / bands; tile < end; ++tile) {
+                if(dirtyHashes[tile]) {
+                    tileHashes[tile] = hashTile(tile / tilesHeight, tile % tilesHeight);
+                    dirtyHashes[tile] = false;
+                }
+            }
+        });
+
+        uint64_t hash = 0;
+
+        for(size_t tile = 0; tile < tileHashes.size(); ++tile) {
+            hash += mixHash(tileHashes[tile] ^ (tile * 0x9E3779B97F4A7C15));
+        }
+
+        return hash;
+    }
+
+    int CellField::getActiveTilesCount() const {
+        return activeTilesCount;
+    }
+
+    int CellField::getTilesCount() const {
+        return tilesWidth * tilesHeight;
+    }
+
+    int CellField::getChangedTileSize() const {
+        return TILE_SIZE;
+    }
+
+    bool CellField::takeChangedTiles(vector<Tile>& tiles) {
+        tiles.clear();
+
+        for(int tile = 0, tilesCount = tilesWidth * tilesHeight; tile < tilesCount; ++tile) {
+            if(untakenTiles[tile]) {
+                tiles.push_back({ tile / tilesHeight, tile % tilesHeight });
+                untakenTiles[tile] = false;
+            }
+        }
+
+        return true;
+    }
+
+    uint32_t CellField::countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const {
+        endX = min(endX, width);
+        endY = min(endY, height);
+
+        uint32_t count = 0;
+
+        for(int x = max(startX, 0); x < endX; ++x) {
+            const Cell* const column = data[x];
+            uint8_t* const blocks = counts + (size_t)((x - startX) / 2) * countsHeight;
+
+            for(int y = max(startY, 0); y < endY; ++y) {
+                const int on = column[y].value & CELL_ON;
+
+                blocks[(y - startY) / 2] += on;
+                count += on;
+            }
+        }
+
+        return count;
+    }
+
+
+    void CellField::forEachCell(function<void(int, int, Cell&)> func) {
+        forEachCell(0, 0, width, height, func);
+    }
+
+    void CellField::forEachCell(int startX, int startY, int endX, int endY, function<void(int, int, Cell&)> func) {
+        CellGrid& data = this->data;
+
+        for(int x = startX; x < endX; ++x) {
+            Cell* const row = data[x];
+
+            for(int y = startY; y < endY; ++y) {
+                func(x, y, row[y]);
+            }
+        }
+    }
+
+    void CellField::forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const {
+        const CellGrid& data = this->data;
+
+        for(int x = startX; x < endX; ++x) {
+            const Cell* const row = data[x];
+
+            for(int y = startY; y < endY; ++y) {
+                if(row[y].isOn())
+                    func(x, y);
+            }
+        }
+    }
+
+    void CellField::copyData(const CellGrid& from, CellGrid& to) const {
+        for(int x = 0; x < dataWidth; ++x) {
+            copy(from[x], from[x] + dataHeight, to[x]);
+        }
+    }
+
+    void CellField::extendDataIfNecessary() {
+        if(width > dataWidth || height > dataHeight) {
+            const int newDataWidth = max(width, dataWidth),
+                      newDataHeight = max(height, dataHeight);
+
+            CellGrid newData(newDataWidth, newDataHeight);
+            copyData(data, newData);
+
+            data = std::move(newData);
+            nextData = CellGrid(newDataWidth, newDataHeight);
+            dataWidth = newDataWidth;
+            dataHeight = newDataHeight;
+        }
+    }
+
+    void CellField::clearOutside() {
+        for(int x = -1; x <= dataWidth; ++x) {
+            Cell* const column = data[x];
+
+            if(x < 0 || x >= width) {
+                std::fill(column - 1, column + dataHeight + 1, CELL_OFF);
+            } else {
+                column[-1] = CELL_OFF;
+                std::fill(column + height, column + dataHeight + 1, CELL_OFF);
+            }
+        }
+    }
+
+    void CellField::updateBorder() {
+        if((topology != TOPOLOGY_TORUS && topology != TOPOLOGY_KLEIN) || width == 0 || height == 0)
+            return;
+
+        CellGrid& data = this->data;
+        const int width = this->width, height = this->height;
+
+        // Верхний и нижний края склеены в обеих топологиях
+        for(int x = 0; x < width; ++x) {
+            data[x][-1] = data[x][height - 1];
+            data[x][height] = data[x][0];
+        }
+
+        // Крайние столбцы копируются целиком, вместе с только что заполненными углами
+        const Cell *const first = data[0] - 1, *const last = data[width - 1] - 1;
+
+        if(topology == TOPOLOGY_TORUS) {
+            copy(last, last + height + 2, data[-1] - 1);
+            copy(first, first + height + 2, data[width] - 1);
+        } else {
+            reverse_copy(last, last + height + 2, data[-1] - 1);
+            reverse_copy(first, first + height + 2, data[width] - 1);
+        }
+    }
+
+    void CellField::fillRandom() {
+        forEachCell([] (int x, int y, Cell& cell) {
+            cell = (rand() * x * y / 2) & CELL_ON;
+        });
+
+        resetTiles();
+    }
+
+    void CellField::clear() {
+        forEachCell([] (int, int, Cell& cell) {
+            cell.off();
+        });
+
+        resetTiles();
+    }
+
+    void CellField::fill() {
+        forEachCell([] (int, int, Cell& cell) {
+            cell.on();
+        });
+
+        resetTiles();
+    }
+
+    bool CellField::stepTile(int tileX, int tileY, const Rules& rules, const CheckZone& checkZone) {
+        const int
+                startX = tileX * TILE_SIZE, endX = min(startX + TILE_SIZE, width),
+                startY = tileY * TILE_SIZE, endY = min(startY + TILE_SIZE, height);
+
+        return kernel(data, nextData, startX, startY, endX, endY, rules, checkZone);
+    }
+
+    bool CellField::stepTileBlock(int tileX, int tileY, int generations, const Rules& rules, const CheckZone& checkZone,
+                                  CellGrid& front, CellGrid& back) {
+        const int
+                startX = tileX * TILE_SIZE, endX = min(startX + TILE_SIZE, width),
+                startY = tileY * TILE_SIZE, endY = min(startY + TILE_SIZE, height),
+                originX = startX - generations, // Глобальные координаты клетки (0, 0) буферов
+                originY = startY - generations;
+
+        // Клетки за пределами поля не меняются, поэтому рамка копируется в оба буфера.
+        // Клетки дальше рамки хранимых данных никогда не читаются
+        const int
+                copyStartX = max(originX, -1), copyEndX = min(endX + generations, dataWidth + 1),
+                copyStartY = max(originY, -1), copyEndY = min(endY + generations, dataHeight + 1);
+
+        for(int x = copyStartX; x < copyEndX; ++x) {
+            const Cell* const column = data[x];
+            copy(column + copyStartY, column + copyEndY, front[x - originX] + (copyStartY - originY));
+            copy(column + copyStartY, column + copyEndY, back[x - originX] + (copyStartY - originY));
+        }
+
+        CellGrid *from = &front, *to = &back;
+
+        // Поколение g верно в участке, расширенном на generations - g клеток (трапеция)
+        for(int generation = 1; generation <= generations; ++generation) {
+            const int extent = generations - generation,
+                      fromX = max(startX - extent, 0) - originX, toX = min(endX + extent, width) - originX,
+                      fromY = max(startY - extent, 0) - originY, toY = min(endY + extent, height) - originY;
+
+            for(int y = fromY; y < toY; y += MAX_KERNEL_HEIGHT) {
+                kernel(*from, *to, fromX, y, toX, min(y + MAX_KERNEL_HEIGHT, toY), rules, checkZone);
+            }
+
+            std::swap(from, to);
+        }
+
+        bool changed = false;
+
+        for(int x = startX; x < endX; ++x) {
+            const Cell* const result = (*from)[x - originX] + (startY - originY);
+            const Cell* const current = data[x] + startY;
+
+            changed = changed || memcmp(result, current, (endY - startY) * sizeof(Cell)) != 0;
+            copy(result, result + (endY - startY), nextData[x] + startY);
+        }
+
+        return changed;
+    }
+
+    void CellField::step(const Rules& rules, const CheckZone& checkZone) {
+        stepBlock(rules, checkZone, 1);
+    }
+
+    void CellField::step(const Rules& rules, const CheckZone& checkZone, int generations) {
+        // При склеенных краях рамка меняется каждое поколение и зависит от противоположного края
+        const bool blocking = topology != TOPOLOGY_TORUS && topology != TOPOLOGY_KLEIN &&
+                (int64_t)width * height >= BLOCK_MIN_CELLS;
+
+        const int maxBlock = blocking ? MAX_BLOCK_GENERATIONS : 1;
+
+        while(generations > 0) {
+            const int block = min(generations, maxBlock);
+            stepBlock(rules, checkZone, block);
+            generations -= block;
+        }
+    }
+
+    void CellField::stepBlock(const Rules& rules, const CheckZone& checkZone, int generations) {
+        if(&rules != lastRules || &checkZone != lastCheckZone) {
+            lastRules = &rules;
+            lastCheckZone = &checkZone;
+            resetTiles();
+            kernel = nullptr;
+        }
+
+        if(kernel == nullptr || kernelSimdLevel != getSimdLevel()) {
+            kernelSimdLevel = getSimdLevel();
+            kernel = stepKernelFor(checkZone, rules, kernelSimdLevel);
+        }
+
+        // Неизменность участка за блок одной длины ничего не говорит о блоке другой длины
+        if(generations != lastBlockGenerations) {
+            lastBlockGenerations = generations;
+            resetTiles();
+        }
+
+        updateBorder();
+
+        // Участок пересчитывается, если на прошлом шаге изменился он сам или его сосед.
+        // Неизменившийся участок в nextData совпадает с data, поэтому его можно не трогать
+        activeTilesCount = 0;
+
+        // При склеенных краях крайние участки соседствуют с противоположными.
+        // Для простоты они пересчитываются, если изменился любой крайний участок
+        bool edgeChanged = false;
+
+        if(topology == TOPOLOGY_TORUS || topology == TOPOLOGY_KLEIN) {
+            for(int tileX = 0; tileX < tilesWidth; ++tileX) {
+                edgeChanged |= changedTiles[tileX * tilesHeight] || changedTiles[tileX * tilesHeight + tilesHeight - 1];
+            }
+
+            for(int tileY = 0; tileY < tilesHeight; ++tileY) {
+                edgeChanged |= changedTiles[tileY] || changedTiles[(tilesWidth - 1) * tilesHeight + tileY];
+            }
+        }
+
+        for(int tileX = 0; tileX < tilesWidth; ++tileX) {
+            for(int tileY = 0; tileY < tilesHeight; ++tileY) {
+                bool active = edgeChanged &&
+                        (tileX == 0 || tileX == tilesWidth - 1 || tileY == 0 || tileY == tilesHeight - 1);
+
+                for(int x = max(tileX - 1, 0), endX = min(tileX + 2, tilesWidth); x < endX && !active; ++x) {
+                    for(int y = max(tileY - 1, 0), endY = min(tileY + 2, tilesHeight); y < endY && !active; ++y) {
+                        active = changedTiles[x * tilesHeight + y];
+                    }
+                }
+
+                activeTiles[tileX * tilesHeight + tileY] = active;
+                activeTilesCount += active;
+            }
+        }
+
+        // Чтение только из data, запись только в nextData, поэтому участки независимы.
+        // Участки делятся на полосы подряд по индексу, а не по столбцам: у поля по умолчанию столбцов участков меньше, чем потоков
+        const int tilesCount = tilesWidth * tilesHeight,
+                  bands = bandsFor(tilesCount);
+
+        parallelFor(bands, [this, &rules, &checkZone, generations, tilesCount, bands] (int band) {
+            const int startTile = (int64_t)tilesCount * band / bands,
+                      endTile = (int64_t)tilesCount * (band + 1) / bands;
+
+            if(generations == 1) {
+                for(int tile = startTile; tile < endTile; ++tile) {
+                    changedTiles[tile] = activeTiles[tile] && stepTile(tile / tilesHeight, tile % tilesHeight, rules, checkZone);
+                    dirtyHashes[tile] |= changedTiles[tile];
+                    untakenTiles[tile] |= changedTiles[tile];
+                }
+
+                return;
+            }
+
+            const int bufferSize = TILE_SIZE + 2 * generations;
+            CellGrid front(bufferSize, bufferSize), back(bufferSize, bufferSize);
+
+            for(int tile = startTile; tile < endTile; ++tile) {
+                changedTiles[tile] = activeTiles[tile] &&
+                        stepTileBlock(tile / tilesHeight, tile % tilesHeight, generations, rules, checkZone, front, back);
+                dirtyHashes[tile] |= changedTiles[tile];
+                untakenTiles[tile] |= changedTiles[tile];
+            }
+        });
+
+        data.swap(nextData);
+    }
+}
+
+#endif // LIFEGAME_CELL_FIELD_CPP
@@ -0,0 +1,63 @@
+#ifndef LIFEGAME_CELL_GRID_CPP
+#define LIFEGAME_CELL_GRID_CPP
+
+#include <algorithm>
+#include <utility>
+#include "cell_grid.h"
+
+namespace lifegame {
+
+    CellGrid::CellGrid(int width, int height):
+            width(width), height(height) {
+
+        // Рамка шириной в 1 клетку вокруг поля
+        stride = height + 2;
+
+        const size_t size = (width + 2) * stride;
+
+        memory = new Cell[size];
+        std::fill(memory, memory + size, CELL_OFF);
+
+        origin = memory + stride + 1;
+    }
+
+    CellGrid::~CellGrid() {
+        free();
+    }
+
+    void CellGrid::free() {
+        delete[] memory;
+        memory = nullptr;
+    }
+
+    CellGrid::CellGrid(CellGrid&& other):
+            width(other.width), height(other.height), stride(other.stride), memory(other.memory), origin(other.origin) {
+        other.memory = nullptr;
+        other.origin = nullptr;
+    }
+
+    CellGrid& CellGrid::operator=(CellGrid&& other) {
+        if(this != &other) {
+            free();
+            width = other.width;
+            height = other.height;
+            stride = other.stride;
+            memory = other.memory;
+            origin = other.origin;
+            other.memory = nullptr;
+            other.origin = nullptr;
+        }
+
+        return *this;
+    }
+
+    void CellGrid::swap(CellGrid& other) {
+        std::swap(width, other.width);
+        std::swap(height, other.height);
+        std::swap(stride, other.stride);
+        std::swap(memory, other.memory);
+        std::swap(origin, other.origin);
+    }
+}
+
+#endif // LIFEGAME_CELL_GRID_CPP
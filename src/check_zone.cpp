@@ -5,6 +5,27 @@
 
 namespace lifegame {
 
+    CheckZone::CheckZone(string name, int neighbourhood):
+            name(name), neighbourhood(neighbourhood) {
+
+        for(int level = 0; level < SIMD_LEVELS; ++level) {
+            columnCounters[level] = columnCounterFor(neighbourhood, (SimdLevel)level);
+        }
+    }
+
+    void CheckZone::countColumn(Cell* prevRow, Cell* currRow, Cell* nextRow, uint8_t* counts, int count) const {
+        const ColumnCounter columnCounter = columnCounters[getSimdLevel()];
+
+        if(columnCounter != nullptr) {
+            columnCounter(prevRow, currRow, nextRow, counts, count);
+            return;
+        }
+
+        for(int y = 0; y < count; ++y) {
+            counts[y] = countNeighbours(prevRow + y, currRow + y, nextRow + y);
+        }
+    }
+
     int QuadCheckZone::countNeighbours(Cell* prevRow, Cell* currRow, Cell* nextRow) const {
         return prevRow[-1].isOn() + prevRow[0].isOn() + prevRow[1].isOn() +
                currRow[-1].isOn() +                     currRow[1].isOn() +
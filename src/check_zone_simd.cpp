@@ -0,0 +1,33 @@
+#ifndef LIFEGAME_CHECK_ZONE_SIMD_CPP
+#define LIFEGAME_CHECK_ZONE_SIMD_CPP
+
+#include "column_counters.h"
+
+namespace lifegame {
+
+    template<int neighbourhood>
+    static ColumnCounter columnCounterFor(SimdLevel level) {
+        #ifdef LIFEGAME_X86
+        switch(level) {
+            case SIMD_AVX512: return countColumnAvx512<neighbourhood>;
+            case SIMD_AVX2:   return countColumnAvx2<neighbourhood>;
+            case SIMD_SSE2:   return countColumnSse2<neighbourhood>;
+            default:          break;
+        }
+        #endif // LIFEGAME_X86
+
+        return countColumnScalar<neighbourhood>;
+    }
+
+    ColumnCounter columnCounterFor(int neighbourhood, SimdLevel level) {
+        switch(neighbourhood) {
+            case QuadCheckZone::NEIGHBOURHOOD:  return columnCounterFor<QuadCheckZone::NEIGHBOURHOOD>(level);
+            case RhombCheckZone::NEIGHBOURHOOD: return columnCounterFor<RhombCheckZone::NEIGHBOURHOOD>(level);
+            case CrossCheckZone::NEIGHBOURHOOD: return columnCounterFor<CrossCheckZone::NEIGHBOURHOOD>(level);
+
+            default:                            return nullptr;
+        }
+    }
+}
+
+#endif // LIFEGAME_CHECK_ZONE_SIMD_CPP
@@ -0,0 +1,392 @@
+#ifndef LIFEGAME_CHUNK_FIELD_CPP
+#define LIFEGAME_CHUNK_FIELD_CPP
+
+#include <stdexcept>
+#include <algorithm>
+#include "chunk_field.h"
+
+namespace lifegame {
+
+    using std::invalid_argument;
+    using std::min;
+    using std::max;
+
+    const ChunkField::Chunk ChunkField::EMPTY_CHUNK {};
+
+    ChunkField::ChunkField(int width, int height):
+            Field(width, height) {}
+
+    ChunkField::~ChunkField() {
+        for(auto& entry : chunks)
+            delete entry.second;
+
+        for(Chunk* chunk : freeChunks)
+            delete chunk;
+    }
+
+    bool ChunkField::isEmpty(const Chunk* chunk) {
+        word_t any = 0;
+
+        for(word_t column : chunk->columns)
+            any |= column;
+
+        return any == 0;
+    }
+
+    const ChunkField::Chunk* ChunkField::findChunk(int chunkX, int chunkY) const {
+        auto found = chunks.find(keyOf(chunkX, chunkY));
+        return found != chunks.end() ? found->second : &EMPTY_CHUNK;
+    }
+
+    ChunkField::Chunk* ChunkField::newChunk() {
+        if(freeChunks.empty())
+            return new Chunk();
+
+        Chunk* chunk = freeChunks.back();
+        freeChunks.pop_back();
+        return chunk;
+    }
+
+    void ChunkField::markChanged(uint64_t key) {
+        if(untakenAll)
+            return;
+
+        untakenKeys.insert(key);
+
+        if(untakenKeys.size() > 2 * chunks.size() + MIN_FREE_CHUNKS) {
+            untakenKeys.clear();
+            untakenAll = true;
+        }
+    }
+
+
+    bool ChunkField::get(int x, int y) const {
+        const Chunk* chunk = findChunk(x >> 6, y >> 6);
+        return (chunk->columns[x & (CHUNK_SIZE - 1)] >> (y & (CHUNK_SIZE - 1))) & 1;
+    }
+
+    void ChunkField::set(int x, int y, bool on) {
+        const uint64_t key = keyOf(x >> 6, y >> 6);
+        auto found = chunks.find(key);
+
+        if(found == chunks.end()) {
+            if(!on)
+                return;
+
+            Chunk* chunk = newChunk();
+            std::fill(chunk->columns, chunk->columns + CHUNK_SIZE, 0);
+            found = chunks.emplace(key, chunk).first;
+        }
+
+        word_t& column = found->second->columns[x & (CHUNK_SIZE - 1)];
+        const word_t bit = (word_t)1 << (y & (CHUNK_SIZE - 1));
+
+        column = on ? column | bit : column & ~bit;
+        markChanged(key);
+    }
+
+    void ChunkField::resize(int width, int height) {
+        this->width = width;
+        this->height = height;
+    }
+
+
+    void ChunkField::stepChunk(int chunkX, int chunkY, Chunk* result, const BitRules& bitRules) const {
+        const Chunk* around[3][3]; // [dx + 1][dy + 1]
+
+        for(int dx = -1; dx <= 1; ++dx) {
+            for(int dy = -1; dy <= 1; ++dy) {
+                around[dx + 1][dy + 1] = findChunk(chunkX + dx, chunkY + dy);
+            }
+        }
+
+        for(int x = 0; x < CHUNK_SIZE; ++x) {
+            word_t above[3], cells[3], below[3];
+
+            for(int c = 0; c < 3; ++c) {
+                // Крайние столбцы берутся из соседних по x участков
+                const int columnX = x + c - 1,
+                          chunk = columnX < 0 ? 0 : columnX >= CHUNK_SIZE ? 2 : 1,
+                          index = columnX & (CHUNK_SIZE - 1);
+
+                above[c] = around[chunk][0]->columns[index];
+                cells[c] = around[chunk][1]->columns[index];
+                below[c] = around[chunk][2]->columns[index];
+            }
+
+            result->columns[x] = bitRules.next(above, cells, below);
+        }
+    }
+
+    void ChunkField::step(const Rules& rules, const CheckZone& checkZone) {
+        if(rules.birth.matches(0))
+            throw invalid_argument("Unbounded field does not support rules with birth at 0 neighbours");
+
+        const BitRules bitRules(rules, checkZone);
+
+        // Клетки могут родиться только в заселённых участках и в тех соседях,
+        // с которыми у участка есть живые клетки на общей стороне или в общем углу
+        candidateKeys.clear();
+
+        for(auto& entry : chunks) {
+            const int chunkX = chunkXOf(entry.first),
+                      chunkY = chunkYOf(entry.first);
+
+            const word_t* const columns = entry.second->columns;
+            word_t any = 0;
+
+            for(int x = 0; x < CHUNK_SIZE; ++x)
+                any |= columns[x];
+
+            const word_t
+                left = columns[0], right = columns[CHUNK_SIZE - 1],
+                topBit = 1, bottomBit = (word_t)1 << (CHUNK_SIZE - 1);
+
+            candidateKeys.insert(entry.first);
+
+            if(left != 0)
+                candidateKeys.insert(keyOf(chunkX - 1, chunkY));
+
+            if(right != 0)
+                candidateKeys.insert(keyOf(chunkX + 1, chunkY));
+
+            if((any & topBit) != 0)
+                candidateKeys.insert(keyOf(chunkX, chunkY - 1));
+
+            if((any & bottomBit) != 0)
+                candidateKeys.insert(keyOf(chunkX, chunkY + 1));
+
+            if((left & topBit) != 0)
+                candidateKeys.insert(keyOf(chunkX - 1, chunkY - 1));
+
+            if((left & bottomBit) != 0)
+                candidateKeys.insert(keyOf(chunkX - 1, chunkY + 1));
+
+            if((right & topBit) != 0)
+                candidateKeys.insert(keyOf(chunkX + 1, chunkY - 1));
+
+            if((right & bottomBit) != 0)
+                candidateKeys.insert(keyOf(chunkX + 1, chunkY + 1));
+        }
+
+        keys.assign(candidateKeys.begin(), candidateKeys.end());
+        results.resize(keys.size());
+        changedResults.resize(keys.size());
+
+        for(Chunk*& result : results)
+            result = newChunk();
+
+        const int count = keys.size(),
+                  bands = bandsFor(count);
+
+        parallelFor(bands, [&] (int band) {
+            for(int i = (int64_t)count * band / bands, end = (int64_t)count * (band + 1) / bands; i < end; ++i) {
+                const int chunkX = chunkXOf(keys[i]), chunkY = chunkYOf(keys[i]);
+
+                stepChunk(chunkX, chunkY, results[i], bitRules);
+                changedResults[i] = !std::equal(results[i]->columns, results[i]->columns + CHUNK_SIZE, findChunk(chunkX, chunkY)->columns);
+            }
+        });
+
+        for(int i = 0; i < count; ++i) {
+            if(changedResults[i])
+                markChanged(keys[i]);
+        }
+
+        for(auto& entry : chunks)
+            freeChunks.push_back(entry.second);
+
+        chunks.clear();
+
+        for(int i = 0; i < count; ++i) {
+            if(isEmpty(results[i])) {
+                freeChunks.push_back(results[i]);
+            } else {
+                chunks.emplace(keys[i], results[i]);
+            }
+        }
+
+        // Следующему шагу нужно примерно столько же участков, лишние освобождаются,
+        // чтобы память не оставалась занятой после того, как узор сжался
+        while((int)freeChunks.size() > max(count, MIN_FREE_CHUNKS)) {
+            delete freeChunks.back();
+            freeChunks.pop_back();
+        }
+
+        processedChunksCount = count;
+    }
+
+
+    void ChunkField::fillWith(bool on) {
+        for(int chunkX = 0; chunkX * CHUNK_SIZE < width; ++chunkX) {
+            for(int chunkY = 0; chunkY * CHUNK_SIZE < height; ++chunkY) {
+                const uint64_t key = keyOf(chunkX, chunkY);
+                auto found = chunks.find(key);
+
+                if(found == chunks.end()) {
+                    if(!on)
+                        continue;
+
+                    Chunk* chunk = newChunk();
+                    std::fill(chunk->columns, chunk->columns + CHUNK_SIZE, 0);
+                    found = chunks.emplace(key, chunk).first;
+                }
+
+                Chunk* chunk = found->second;
+
+                const int rows = min(height - chunkY * CHUNK_SIZE, CHUNK_SIZE);
+                const word_t mask = rows == CHUNK_SIZE ? ~(word_t)0 : ((word_t)1 << rows) - 1;
+
+                for(int x = 0, columns = min(width - chunkX * CHUNK_SIZE, CHUNK_SIZE); x < columns; ++x) {
+                    chunk->columns[x] = on ? chunk->columns[x] | mask : chunk->columns[x] & ~mask;
+                }
+
+                if(!on && isEmpty(chunk)) {
+                    chunks.erase(found);
+                    freeChunks.push_back(chunk);
+                }
+            }
+        }
+
+        untakenKeys.clear();
+        untakenAll = true;
+    }
+
+    void ChunkField::clear() {
+        fillWith(false);
+    }
+
+    void ChunkField::fill() {
+        fillWith(true);
+    }
+
+    void ChunkField::forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const {
+        if(startX >= endX || startY >= endY)
+            return;
+
+        const int
+                startChunkX = startX >> 6, endChunkX = (endX - 1) >> 6,
+                startChunkY = startY >> 6, endChunkY = (endY - 1) >> 6;
+
+        auto visit = [&] (int chunkX, int chunkY, const Chunk* chunk) {
+            const int baseX = chunkX * CHUNK_SIZE,
+                      baseY = chunkY * CHUNK_SIZE;
+
+            for(int x = max(startX - baseX, 0), columns = min(endX - baseX, CHUNK_SIZE); x < columns; ++x) {
+                word_t column = chunk->columns[x];
+
+                while(column != 0) {
+                    const int y = baseY + __builtin_ctzll(column);
+
+                    if(y >= startY && y < endY)
+                        func(baseX + x, y);
+
+                    column &= column - 1;
+                }
+            }
+        };
+
+        // Обходим то, чего меньше: участки прямоугольника или хранимые участки
+        if((int64_t)(endChunkX - startChunkX + 1) * (endChunkY - startChunkY + 1) <= (int64_t)chunks.size()) {
+            for(int chunkX = startChunkX; chunkX <= endChunkX; ++chunkX) {
+                for(int chunkY = startChunkY; chunkY <= endChunkY; ++chunkY) {
+                    const Chunk* chunk = findChunk(chunkX, chunkY);
+
+                    if(chunk != &EMPTY_CHUNK)
+                        visit(chunkX, chunkY, chunk);
+                }
+            }
+
+        } else {
+            for(auto& entry : chunks) {
+                const int chunkX = chunkXOf(entry.first),
+                          chunkY = chunkYOf(entry.first);
+
+                if(chunkX >= startChunkX && chunkX <= endChunkX && chunkY >= startChunkY && chunkY <= endChunkY)
+                    visit(chunkX, chunkY, entry.second);
+            }
+        }
+    }
+
+    uint64_t ChunkField::hash() {
+        uint64_t hash = 0;
+
+        // Порядок обхода хеш-таблицы не определён, поэтому хеши участков складываются
+        for(auto& entry : chunks) {
+            uint64_t chunkHash = entry.first;
+
+            for(word_t column : entry.second->columns) {
+                chunkHash = hashWord(chunkHash, column);
+            }
+
+            hash += mixHash(chunkHash);
+        }
+
+        return hash;
+    }
+
+    int ChunkField::getActiveTilesCount() const {
+        return processedChunksCount;
+    }
+
+    int ChunkField::getTilesCount() const {
+        return chunks.size();
+    }
+
+    int ChunkField::getChangedTileSize() const {
+        return CHUNK_SIZE;
+    }
+
+    bool ChunkField::takeChangedTiles(vector<Tile>& tiles) {
+        tiles.clear();
+
+        if(untakenAll) {
+            untakenAll = false;
+            return false;
+        }
+
+        for(uint64_t key : untakenKeys)
+            tiles.push_back({ chunkXOf(key), chunkYOf(key) });
+
+        untakenKeys.clear();
+        return true;
+    }
+
+    uint32_t ChunkField::countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const {
+        if(startX >= endX || startY >= endY)
+            return 0;
+
+        uint32_t count = 0;
+
+        for(int chunkX = startX >> 6; chunkX <= (endX - 1) >> 6; ++chunkX) {
+            for(int chunkY = startY >> 6; chunkY <= (endY - 1) >> 6; ++chunkY) {
+                const Chunk* const chunk = findChunk(chunkX, chunkY);
+
+                if(chunk == &EMPTY_CHUNK)
+                    continue;
+
+                const int baseX = chunkX * CHUNK_SIZE, baseY = chunkY * CHUNK_SIZE,
+                          firstRow = max(startY - baseY, 0), endRow = min(endY - baseY, CHUNK_SIZE);
+
+                // Строки за пределами прямоугольника маскируются, строка firstRow чётная и становится битом 0
+                const word_t mask = (endRow == CHUNK_SIZE ? ~(word_t)0 : ((word_t)1 << endRow) - 1) & ~(((word_t)1 << firstRow) - 1);
+
+                for(int x = max(startX - baseX, 0), columns = min(endX - baseX, CHUNK_SIZE); x < columns; x += 2) {
+                    const word_t
+                            left = (chunk->columns[x] & mask) >> firstRow,
+                            right = x + 1 < columns ? (chunk->columns[x + 1] & mask) >> firstRow : 0;
+
+                    if((left | right) == 0)
+                        continue;
+
+                    countWordBlocks(left, right, counts + (size_t)((baseX + x - startX) / 2) * countsHeight + (baseY + firstRow - startY) / 2);
+                    count += __builtin_popcountll(left) + __builtin_popcountll(right);
+                }
+            }
+        }
+
+        return count;
+    }
+}
+
+#endif // LIFEGAME_CHUNK_FIELD_CPP
@@ -0,0 +1,48 @@
+#ifndef LIFEGAME_CYCLE_DETECTOR_CPP
+#define LIFEGAME_CYCLE_DETECTOR_CPP
+
+#include "cycle_detector.h"
+
+namespace lifegame {
+
+    const char* const CYCLE_ACTION_NAMES[CYCLE_ACTIONS] = { "off", "pause", "skip", "idle" };
+
+    void CycleDetector::reset() {
+        history.clear();
+        nextEntry = 0;
+        period = 0;
+        cycleStart = 0;
+    }
+
+    uint64_t CycleDetector::add(uint64_t generation, uint64_t hash) {
+        uint64_t distance = 0, start = generation;
+
+        for(const Entry& entry : history) {
+            if(entry.hash == hash) {
+                if(distance == 0 || generation - entry.generation < distance)
+                    distance = generation - entry.generation;
+
+                if(entry.generation < start)
+                    start = entry.generation;
+            }
+        }
+
+        if(distance != 0)
+            cycleStart = start;
+
+        if(history.size() < HISTORY_SIZE) {
+            history.push_back({ generation, hash });
+        } else {
+            history[nextEntry] = { generation, hash };
+            nextEntry = (nextEntry + 1) % HISTORY_SIZE;
+        }
+
+        return distance;
+    }
+
+    void CycleDetector::setPeriod(uint64_t period) {
+        this->period = period;
+    }
+}
+
+#endif // LIFEGAME_CYCLE_DETECTOR_CPP
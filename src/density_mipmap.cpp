@@ -0,0 +1,169 @@
+#ifndef LIFEGAME_DENSITY_MIPMAP_CPP
+#define LIFEGAME_DENSITY_MIPMAP_CPP
+
+#include <algorithm>
+#include "density_mipmap.h"
+
+namespace lifegame {
+
+    /** Наибольшее кратное size, не превосходящее value */
+    static inline int floorTo(int value, int size) {
+        return value - ((value % size) + size) % size;
+    }
+
+    void DensityMipmap::updateTile(const Field& field, int tileX, int tileY) {
+        const int
+                blocks = tileSize / 2,
+                cellX = originX + tileX * tileSize,
+                cellY = originY + tileY * tileSize;
+
+        // Клетки за краем ограниченного поля не считаются, блоки на краю получаются как при пустых клетках снаружи
+        std::fill(tileCounts.begin(), tileCounts.end(), 0);
+        const uint32_t count = field.countBlocks(cellX, cellY, cellX + tileSize, cellY + tileSize, tileCounts.data(), blocks);
+
+        uint32_t& tilePopulation = tilePopulations[(size_t)tileX * tilesHeight + tileY];
+        population = population - tilePopulation + count;
+        tilePopulation = count;
+
+        if(levels.empty())
+            return;
+
+        vector<uint8_t>& level = levels[0];
+        const int blocksHeight = levelHeight(1);
+
+        for(int x = 0; x < blocks; ++x) {
+            uint8_t* const column = &level[(size_t)(tileX * blocks + x) * blocksHeight + tileY * blocks];
+            const uint8_t* const counts = &tileCounts[(size_t)x * blocks];
+
+            for(int y = 0; y < blocks; ++y)
+                column[y] = (counts[y] * 255 + 2) / 4;
+        }
+    }
+
+    void DensityMipmap::updateBlocks(int level, int startX, int startY, int endX, int endY) {
+        const int
+                previousWidth = levelWidth(level - 1),
+                previousHeight = levelHeight(level - 1),
+                blocksHeight = levelHeight(level);
+
+        const uint8_t* const previous = levels[level - 2].data();
+        uint8_t* const blocks = levels[level - 1].data();
+
+        // Блоки предыдущего уровня за краем пирамиды (при нечётной его стороне) считаются пустыми
+        for(int x = startX; x < endX; ++x) {
+            const uint8_t* const left = previous + (size_t)x * 2 * previousHeight;
+            const uint8_t* const right = x * 2 + 1 < previousWidth ? left + previousHeight : nullptr;
+            uint8_t* const column = blocks + (size_t)x * blocksHeight;
+
+            for(int y = startY; y < endY; ++y) {
+                const bool bottom = y * 2 + 1 < previousHeight;
+                int sum = left[y * 2] + (bottom ? left[y * 2 + 1] : 0);
+
+                if(right != nullptr)
+                    sum += right[y * 2] + (bottom ? right[y * 2 + 1] : 0);
+
+                column[y] = (sum + 2) / 4;
+            }
+        }
+    }
+
+    void DensityMipmap::update(Field& field, int levelsCount, int startX, int startY, int width, int height) {
+        const bool tracked = field.takeChangedTiles(changedTiles);
+        const int fieldTileSize = tracked ? field.getChangedTileSize() : DEFAULT_TILE_SIZE;
+
+        // Если блок верхнего уровня больше участка, изменение участка задевает соседние, и пирамида просто строится заново
+        const bool full = !tracked || fieldTileSize % (1 << levelsCount) != 0 ||
+                          startX != this->startX || startY != this->startY || width != this->width || height != this->height ||
+                          levelsCount != (int)levels.size() || fieldTileSize != tileSize;
+
+        if(full) {
+            this->startX = startX;
+            this->startY = startY;
+            this->width = width;
+            this->height = height;
+            tileSize = fieldTileSize;
+            originX = floorTo(startX, tileSize);
+            originY = floorTo(startY, tileSize);
+            tilesWidth = (startX + width - originX + tileSize - 1) / tileSize;
+            tilesHeight = (startY + height - originY + tileSize - 1) / tileSize;
+
+            levels.resize(levelsCount);
+
+            for(int level = 1; level <= levelsCount; ++level)
+                levels[level - 1].assign((size_t)levelWidth(level) * levelHeight(level), 0);
+
+            tilePopulations.assign((size_t)tilesWidth * tilesHeight, 0);
+            population = 0;
+            tileCounts.resize((size_t)(tileSize / 2) * (tileSize / 2));
+
+            for(int tileX = 0; tileX < tilesWidth; ++tileX) {
+                for(int tileY = 0; tileY < tilesHeight; ++tileY) {
+                    updateTile(field, tileX, tileY);
+                }
+            }
+
+            for(int level = 2; level <= levelsCount; ++level)
+                updateBlocks(level, 0, 0, levelWidth(level), levelHeight(level));
+
+            return;
+        }
+
+        const int originTileX = originX / tileSize, originTileY = originY / tileSize;
+
+        // Сторона участка кратна блоку верхнего уровня, поэтому каждый блок лежит ровно в одном участке
+        // и пересчитывается один раз, сколько бы соседних участков ни изменилось
+        for(const Field::Tile& tile : changedTiles) {
+            const int tileX = tile.x - originTileX, tileY = tile.y - originTileY;
+
+            if(tileX < 0 || tileX >= tilesWidth || tileY < 0 || tileY >= tilesHeight)
+                continue;
+
+            updateTile(field, tileX, tileY);
+
+            for(int level = 2; level <= levelsCount; ++level) {
+                const int blocks = tileSize >> level;
+                updateBlocks(level, tileX * blocks, tileY * blocks, (tileX + 1) * blocks, (tileY + 1) * blocks);
+            }
+        }
+    }
+
+    void DensityMipmap::copyLevel(const Field& field, int level, int startX, int startY, int width, int height,
+                                  vector<uint8_t>& density) const {
+
+        const int
+                blocksWidth = (width + (1 << level) - 1) >> level,
+                blocksHeight = (height + (1 << level) - 1) >> level;
+
+        if(level == 0) {
+            density.assign((size_t)width * height, 0);
+
+            field.forEachOn(startX, startY, startX + width, startY + height, [&density, startX, startY, height] (int x, int y) {
+                density[(size_t)(x - startX) * height + (y - startY)] = 255;
+            });
+
+            return;
+        }
+
+        const int sourceHeight = levelHeight(level);
+
+        density.resize((size_t)blocksWidth * blocksHeight);
+
+        for(int x = 0; x < blocksWidth; ++x) {
+            const size_t offset = (size_t)(((startX - originX) >> level) + x) * sourceHeight + ((startY - originY) >> level);
+            std::copy_n(&levels[level - 1][offset], blocksHeight, &density[(size_t)x * blocksHeight]);
+        }
+    }
+
+    void DensityMipmap::clear() {
+        startX = startY = width = height = 0;
+        originX = originY = 0;
+        tileSize = tilesWidth = tilesHeight = 0;
+        population = 0;
+        vector<vector<uint8_t>>().swap(levels);
+        vector<uint32_t>().swap(tilePopulations);
+        vector<Field::Tile>().swap(changedTiles);
+        vector<uint8_t>().swap(tileCounts);
+    }
+}
+
+#endif // LIFEGAME_DENSITY_MIPMAP_CPP
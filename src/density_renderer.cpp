@@ -0,0 +1,40 @@
+#ifndef LIFEGAME_DENSITY_RENDERER_CPP
+#define LIFEGAME_DENSITY_RENDERER_CPP
+
+#include "density_renderer.h"
+
+namespace lifegame {
+
+    void DensityRenderer::draw(RenderTarget& target, const Snapshot& snapshot, int, int) {
+        const int width = snapshot.densityWidth(), height = snapshot.densityHeight();
+
+        if(width <= 0 || height <= 0)
+            return;
+
+        if(snapshot.serial != lastSerial) {
+            if(texture.getSize() != Vector2u(width, height)) {
+                pixels.resize((size_t)width * height * 4);
+                texture.create(width, height);
+                sprite.setTexture(texture, true);
+            }
+
+            // Снимок хранится по столбцам, текстура - по строкам
+            for(int x = 0; x < width; ++x) {
+                const uint8_t* const column = &snapshot.density[(size_t)x * height];
+                Uint8* pixel = &pixels[(size_t)x * 4];
+
+                for(int y = 0; y < height; ++y, pixel += (size_t)width * 4) {
+                    pixel[0] = pixel[1] = pixel[2] = brightness(column[y]);
+                    pixel[3] = 255;
+                }
+            }
+
+            texture.update(pixels.data());
+            lastSerial = snapshot.serial;
+        }
+
+        target.draw(sprite);
+    }
+}
+
+#endif // LIFEGAME_DENSITY_RENDERER_CPP
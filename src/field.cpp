@@ -0,0 +1,155 @@
+#ifndef LIFEGAME_FIELD_CPP
+#define LIFEGAME_FIELD_CPP
+
+#include <stdexcept>
+#include <cstdlib>
+#include <algorithm>
+#include "field.h"
+#include "cell_field.h"
+#include "bit_field.h"
+#include "hash_life_field.h"
+#include "chunk_field.h"
+
+namespace lifegame {
+
+    using std::invalid_argument;
+    using std::min;
+    using std::max;
+
+    const char* const TOPOLOGY_NAMES[TOPOLOGIES] = { "plane", "dead", "torus", "klein" };
+
+    const vector<string> Field::types { "cell", "bit", "hashlife", "chunk" };
+
+    Field* Field::create(const string& type, int width, int height) {
+        if(type == "cell")
+            return new CellField(width, height);
+
+        if(type == "bit")
+            return new BitField(width, height);
+
+        if(type == "hashlife")
+            return new HashLifeField(width, height);
+
+        if(type == "chunk")
+            return new ChunkField(width, height);
+
+        throw invalid_argument("Unknown field type \"" + type + "\"");
+    }
+
+
+    bool Field::supportsTopology(Topology topology) const {
+        return topology == TOPOLOGY_PLANE;
+    }
+
+    void Field::setTopology(Topology topology) {
+        if(!supportsTopology(topology))
+            throw invalid_argument(string("Field does not support topology \"") + TOPOLOGY_NAMES[topology] + "\"");
+
+        this->topology = topology;
+    }
+
+    void Field::setThreadPool(ThreadPool* threadPool) {
+        this->threadPool = threadPool;
+    }
+
+    void Field::parallelFor(int count, const function<void(int)>& func) {
+        if(threadPool != nullptr) {
+            threadPool->run(count, func);
+        } else {
+            for(int i = 0; i < count; ++i) {
+                func(i);
+            }
+        }
+    }
+
+    int Field::bandsFor(int count) const {
+        const int bands = threadPool != nullptr ? threadPool->getThreadsCount() * 4 : 1;
+        return max(min(bands, count), 1);
+    }
+
+
+    void Field::step(const Rules& rules, const CheckZone& checkZone, int generations) {
+        for(int i = 0; i < generations; ++i) {
+            step(rules, checkZone);
+        }
+    }
+
+
+    void Field::fillRandom() {
+        for(int x = 0; x < width; ++x) {
+            for(int y = 0; y < height; ++y) {
+                set(x, y, (rand() * x * y / 2) & CELL_ON);
+            }
+        }
+    }
+
+    void Field::clear() {
+        for(int x = 0; x < width; ++x) {
+            for(int y = 0; y < height; ++y) {
+                set(x, y, false);
+            }
+        }
+    }
+
+    void Field::fill() {
+        for(int x = 0; x < width; ++x) {
+            for(int y = 0; y < height; ++y) {
+                set(x, y, true);
+            }
+        }
+    }
+
+    void Field::forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const {
+        for(int x = startX; x < endX; ++x) {
+            for(int y = startY; y < endY; ++y) {
+                if(get(x, y))
+                    func(x, y);
+            }
+        }
+    }
+
+    void Field::forEachOn(function<void(int, int)> func) const {
+        forEachOn(0, 0, width, height, func);
+    }
+
+    uint64_t Field::hash() {
+        uint64_t hash = 0;
+
+        // Сумма не зависит от порядка обхода клеток
+        forEachOn([&hash] (int x, int y) {
+            hash += mixHash((uint64_t)(uint32_t)x << 32 | (uint32_t)y);
+        });
+
+        return hash;
+    }
+
+    int Field::getActiveTilesCount() const {
+        return 0;
+    }
+
+    int Field::getTilesCount() const {
+        return 0;
+    }
+
+    int Field::getChangedTileSize() const {
+        return 0;
+    }
+
+    bool Field::takeChangedTiles(vector<Tile>& tiles) {
+        tiles.clear();
+        return false;
+    }
+
+    uint32_t Field::countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const {
+        uint32_t count = 0;
+
+        forEachOn(startX, startY, endX, endY, [startX, startY, counts, countsHeight, &count] (int x, int y) {
+            ++counts[(size_t)((x - startX) / 2) * countsHeight + (y - startY) / 2];
+            ++count;
+        });
+
+        return count;
+    }
+}
+
+#endif // LIFEGAME_FIELD_CPP
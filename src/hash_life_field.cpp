@@ -0,0 +1,568 @@
+#ifndef LIFEGAME_HASH_LIFE_FIELD_CPP
+#define LIFEGAME_HASH_LIFE_FIELD_CPP
+
+#include <stdexcept>
+#include <cstdlib>
+#include "hash_life_field.h"
+
+namespace lifegame {
+
+    using std::invalid_argument;
+    using std::max;
+    using std::min;
+
+    size_t HashLifeField::defaultMemoryLimit = (size_t)256 << 20;
+
+    static const size_t INITIAL_BUCKETS_COUNT = 1 << 16;
+
+    HashLifeField::HashLifeField(int width, int height, size_t memoryLimit):
+            Field(width, height),
+            deadLeaf{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 0, 0, 0, -1, false },
+            aliveLeaf{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, 1, mixHash(1), 0, -1, false },
+            buckets(INITIAL_BUCKETS_COUNT, nullptr),
+            memoryLimit(memoryLimit),
+            emptyNodes{ &deadLeaf } {
+
+        int level = 3;
+
+        while((int64_t)1 << (level - 1) < max(width, height))
+            ++level;
+
+        root = empty(level);
+    }
+
+    HashLifeField::~HashLifeField() {
+        for(Node* node : buckets) {
+            while(node != nullptr) {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+        }
+    }
+
+
+    static inline size_t hashOf(const void* nw, const void* ne, const void* sw, const void* se) {
+        size_t hash = (size_t)nw;
+        hash = hash * 0x9E3779B97F4A7C15 + (size_t)ne;
+        hash = hash * 0x9E3779B97F4A7C15 + (size_t)sw;
+        hash = hash * 0x9E3779B97F4A7C15 + (size_t)se;
+        return hash ^ (hash >> 29);
+    }
+
+    HashLifeField::Node* HashLifeField::join(Node* nw, Node* ne, Node* sw, Node* se) {
+        const size_t hash = hashOf(nw, ne, sw, se);
+        Node*& bucket = buckets[hash & (buckets.size() - 1)];
+
+        for(Node* node = bucket; node != nullptr; node = node->next) {
+            if(node->nw == nw && node->ne == ne && node->sw == sw && node->se == se)
+                return node;
+        }
+
+        Node* node = new Node {
+            nw, ne, sw, se, bucket, nullptr,
+            nw->population + ne->population + sw->population + se->population,
+            contentHashOf(nw->level + 1, nw, ne, sw, se),
+            nw->level + 1, -1, false
+        };
+
+        bucket = node;
+
+        if(++nodesCount > buckets.size())
+            rehash(buckets.size() * 2);
+
+        // Новый узел уже в таблице, поэтому после прерывания его удалит сборка мусора
+        if(limitMemory && getMemoryUsage() > memoryLimit)
+            throw MemoryLimitExceeded();
+
+        return node;
+    }
+
+    void HashLifeField::rehash(size_t bucketsCount) {
+        vector<Node*> newBuckets(bucketsCount, nullptr);
+
+        for(Node* node : buckets) {
+            while(node != nullptr) {
+                Node* next = node->next;
+                Node*& bucket = newBuckets[hashOf(node->nw, node->ne, node->sw, node->se) & (bucketsCount - 1)];
+                node->next = bucket;
+                bucket = node;
+                node = next;
+            }
+        }
+
+        buckets.swap(newBuckets);
+    }
+
+    HashLifeField::Node* HashLifeField::empty(int level) {
+        while((int)emptyNodes.size() <= level) {
+            Node* e = emptyNodes.back();
+            emptyNodes.push_back(join(e, e, e, e));
+        }
+
+        return emptyNodes[level];
+    }
+
+    HashLifeField::Node* HashLifeField::expand(Node* node) {
+        Node* e = empty(node->level - 1);
+
+        return join(
+                join(e, e, e, node->nw), join(e, e, node->ne, e),
+                join(e, node->sw, e, e), join(node->se, e, e, e)
+        );
+    }
+
+    HashLifeField::Node* HashLifeField::centre(Node* node) {
+        return join(node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+    }
+
+    HashLifeField::Node* HashLifeField::horizontalCentre(Node* w, Node* e) {
+        return join(w->ne, e->nw, w->se, e->sw);
+    }
+
+    HashLifeField::Node* HashLifeField::verticalCentre(Node* n, Node* s) {
+        return join(n->sw, n->se, s->nw, s->ne);
+    }
+
+    bool HashLifeField::isPadded(Node* node) const {
+        return node->nw->population == node->nw->se->population &&
+               node->ne->population == node->ne->sw->population &&
+               node->sw->population == node->sw->ne->population &&
+               node->se->population == node->se->nw->population;
+    }
+
+
+    uint64_t HashLifeField::contentHashOf(int level, const Node* nw, const Node* ne, const Node* sw, const Node* se) {
+        uint64_t hash = hashWord(level, nw->contentHash);
+        hash = hashWord(hash, ne->contentHash);
+        hash = hashWord(hash, sw->contentHash);
+        hash = hashWord(hash, se->contentHash);
+        return mixHash(hash);
+    }
+
+    uint64_t HashLifeField::hash() {
+        const Node *nw = root->nw, *ne = root->ne, *sw = root->sw, *se = root->se;
+        int level = root->level;
+
+        // Пустые рамки, добавленные expand(), отбрасываются: спускаемся к центру, пока снаружи нет живых клеток.
+        // Центр не строится через join, чтобы подсчёт хеша не создавал узлов
+        while(level > 1 &&
+                nw->population == nw->se->population && ne->population == ne->sw->population &&
+                sw->population == sw->ne->population && se->population == se->nw->population) {
+
+            nw = nw->se;
+            ne = ne->sw;
+            sw = sw->ne;
+            se = se->nw;
+            --level;
+        }
+
+        return contentHashOf(level, nw, ne, sw, se);
+    }
+
+
+    HashLifeField::Node* HashLifeField::leafStep(Node* node) {
+        bool cells[4][4];
+
+        for(int x = 0; x < 4; ++x) {
+            for(int y = 0; y < 4; ++y) {
+                const Node* quarter = x < 2 ? (y < 2 ? node->nw : node->sw) : (y < 2 ? node->ne : node->se);
+                const Node* leaf = x & 1 ? (y & 1 ? quarter->se : quarter->ne) : (y & 1 ? quarter->sw : quarter->nw);
+                cells[x][y] = leaf->population != 0;
+            }
+        }
+
+        Node* next[2][2];
+
+        for(int x = 1; x <= 2; ++x) {
+            for(int y = 1; y <= 2; ++y) {
+                int count = 0;
+
+                for(int dx = -1; dx <= 1; ++dx) {
+                    for(int dy = -1; dy <= 1; ++dy) {
+                        if(neighbourhood & neighbourBit(dx, dy))
+                            count += cells[x + dx][y + dy];
+                    }
+                }
+
+                next[x - 1][y - 1] = (cells[x][y] ? survive[count] : birth[count]) ? &aliveLeaf : &deadLeaf;
+            }
+        }
+
+        return join(next[0][0], next[1][0], next[0][1], next[1][1]);
+    }
+
+    HashLifeField::Node* HashLifeField::successor(Node* node) {
+        const int level = node->level,
+                  exponent = min(stepExponent, level - 2);
+
+        if(node->result != nullptr && node->resultExponent == exponent)
+            return node->result;
+
+        Node* result;
+
+        if(node->population == 0) {
+            result = empty(level - 1);
+
+        } else if(level == 2) {
+            result = leafStep(node);
+
+        } else {
+            Node
+                *n00 = node->nw,
+                *n01 = horizontalCentre(node->nw, node->ne),
+                *n02 = node->ne,
+                *n10 = verticalCentre(node->nw, node->sw),
+                *n11 = centre(node),
+                *n12 = verticalCentre(node->ne, node->se),
+                *n20 = node->sw,
+                *n21 = horizontalCentre(node->sw, node->se),
+                *n22 = node->se;
+
+            Node
+                *r00 = successor(n00), *r01 = successor(n01), *r02 = successor(n02),
+                *r10 = successor(n10), *r11 = successor(n11), *r12 = successor(n12),
+                *r20 = successor(n20), *r21 = successor(n21), *r22 = successor(n22);
+
+            if(stepExponent >= level - 2) {
+                // Полный шаг: ещё 2^(level - 3) поколений для каждой четверти
+                result = join(
+                        successor(join(r00, r01, r10, r11)), successor(join(r01, r02, r11, r12)),
+                        successor(join(r10, r11, r20, r21)), successor(join(r11, r12, r21, r22))
+                );
+
+            } else {
+                // Шаг меньше половины узла: после первой фазы берём только центры
+                result = join(
+                        centre(join(r00, r01, r10, r11)), centre(join(r01, r02, r11, r12)),
+                        centre(join(r10, r11, r20, r21)), centre(join(r11, r12, r21, r22))
+                );
+            }
+        }
+
+        node->resultExponent = exponent;
+        return node->result = result;
+    }
+
+
+    void HashLifeField::setRules(int exponent, const Rules& rules, const CheckZone& checkZone) {
+        if(rules.birth.matches(0))
+            throw invalid_argument("HashLife does not support rules with birth at 0 neighbours");
+
+        stepExponent = exponent;
+
+        if(rules.birth.value == resultBirth && rules.survive.value == resultSurvive &&
+                checkZone.neighbourhood == resultNeighbourhood)
+            return;
+
+        clearResults();
+
+        resultBirth = rules.birth.value;
+        resultSurvive = rules.survive.value;
+        resultNeighbourhood = neighbourhood = checkZone.neighbourhood;
+
+        for(int n = 0; n <= MAX_RULE_NUMS; ++n) {
+            birth[n] = rules.birth.matches(n);
+            survive[n] = rules.survive.matches(n);
+        }
+    }
+
+    void HashLifeField::clearResults() {
+        for(Node* node : buckets) {
+            for(; node != nullptr; node = node->next)
+                node->result = nullptr;
+        }
+    }
+
+    void HashLifeField::step(const Rules& rules, const CheckZone& checkZone) {
+        advance(0, rules, checkZone);
+    }
+
+    void HashLifeField::step(const Rules& rules, const CheckZone& checkZone, int generations) {
+        for(int exponent = 30; exponent >= 0; --exponent) {
+            if(generations & (1 << exponent))
+                advance(exponent, rules, checkZone);
+        }
+    }
+
+    void HashLifeField::advance(int exponent, const Rules& rules, const CheckZone& checkZone) {
+        if(exponent < 0 || exponent > MAX_LEVEL - 3)
+            throw invalid_argument("Step exponent must be in range [0, " + std::to_string(MAX_LEVEL - 3) + "]");
+
+        setRules(exponent, rules, checkZone);
+
+        if(getMemoryUsage() > memoryLimit)
+            collectGarbage();
+
+        // За 2^exponent поколений узор расширяется не более чем на 2^exponent клеток,
+        // поэтому корень должен быть с запасом не меньше этого значения
+        while(root->level < exponent + 2 || !isPadded(root)) {
+            if(root->level >= MAX_LEVEL - 1)
+                throw invalid_argument("Pattern is too large for HashLife universe");
+
+            root = expand(root);
+        }
+
+        Node* const start = expand(root);
+
+        try {
+            limitMemory = true;
+            root = successor(start);
+            limitMemory = false;
+
+        } catch(const MemoryLimitExceeded&) {
+            limitMemory = false;
+
+            // Незаконченные промежуточные узлы недостижимы из корня и удаляются.
+            // Если памяти мало даже для самой вселенной, шаг считается без ограничения:
+            // иначе он дробился бы вплоть до 2^exponent шагов по одному поколению
+            collectGarbage();
+
+            if(exponent == 0 || getMemoryUsage() > memoryLimit / 2) {
+                root = successor(expand(root));
+            } else {
+                advance(exponent - 1, rules, checkZone);
+                advance(exponent - 1, rules, checkZone);
+            }
+        }
+
+        if(getMemoryUsage() > memoryLimit)
+            collectGarbage();
+    }
+
+
+    void HashLifeField::mark(Node* node) {
+        if(node->level == 0 || node->marked)
+            return;
+
+        node->marked = true;
+
+        mark(node->nw);
+        mark(node->ne);
+        mark(node->sw);
+        mark(node->se);
+
+        if(node->result != nullptr)
+            mark(node->result);
+    }
+
+    void HashLifeField::sweep() {
+        for(Node*& bucket : buckets) {
+            Node** link = &bucket;
+
+            while(*link != nullptr) {
+                Node* node = *link;
+
+                if(node->marked) {
+                    node->marked = false;
+                    link = &node->next;
+                } else {
+                    *link = node->next;
+                    delete node;
+                    --nodesCount;
+                }
+            }
+        }
+    }
+
+    void HashLifeField::collectGarbage() {
+        mark(root);
+
+        for(Node* node : emptyNodes)
+            mark(node);
+
+        sweep();
+
+        if(getMemoryUsage() > memoryLimit / 2) {
+            clearResults();
+
+            mark(root);
+
+            for(Node* node : emptyNodes)
+                mark(node);
+
+            sweep();
+        }
+    }
+
+    uint64_t HashLifeField::getPopulation() const {
+        return root->population;
+    }
+
+    size_t HashLifeField::getNodesCount() const {
+        return nodesCount;
+    }
+
+    size_t HashLifeField::getMemoryUsage() const {
+        return nodesCount * sizeof(Node) + buckets.size() * sizeof(Node*);
+    }
+
+    void HashLifeField::setMemoryLimit(size_t memoryLimit) {
+        this->memoryLimit = memoryLimit;
+
+        if(getMemoryUsage() > memoryLimit)
+            collectGarbage();
+    }
+
+
+    int64_t HashLifeField::rootHalf() const {
+        return (int64_t)1 << (root->level - 1);
+    }
+
+    bool HashLifeField::get(int x, int y) const {
+        int64_t half = rootHalf();
+
+        if(x < -half || x >= half || y < -half || y >= half)
+            return false;
+
+        const Node* node = root;
+        int64_t nodeX = x + half, nodeY = y + half;
+
+        while(node->level > 0) {
+            if(node->population == 0)
+                return false;
+
+            half = (int64_t)1 << (node->level - 1);
+
+            if(nodeX < half) {
+                node = nodeY < half ? node->nw : node->sw;
+            } else {
+                node = nodeY < half ? node->ne : node->se;
+                nodeX -= half;
+            }
+
+            if(nodeY >= half)
+                nodeY -= half;
+        }
+
+        return node->population != 0;
+    }
+
+    HashLifeField::Node* HashLifeField::setCell(Node* node, int64_t x, int64_t y, bool on) {
+        if(node->level == 0)
+            return on ? &aliveLeaf : &deadLeaf;
+
+        const int64_t half = (int64_t)1 << (node->level - 1);
+
+        if(y < half) {
+            return x < half ?
+                    join(setCell(node->nw, x, y, on), node->ne, node->sw, node->se) :
+                    join(node->nw, setCell(node->ne, x - half, y, on), node->sw, node->se);
+        } else {
+            return x < half ?
+                    join(node->nw, node->ne, setCell(node->sw, x, y - half, on), node->se) :
+                    join(node->nw, node->ne, node->sw, setCell(node->se, x - half, y - half, on));
+        }
+    }
+
+    void HashLifeField::set(int x, int y, bool on) {
+        while(x < -rootHalf() || x >= rootHalf() || y < -rootHalf() || y >= rootHalf())
+            root = expand(root);
+
+        root = setCell(root, x + rootHalf(), y + rootHalf(), on);
+
+        if(getMemoryUsage() > memoryLimit)
+            collectGarbage();
+    }
+
+    void HashLifeField::resize(int width, int height) {
+        this->width = width;
+        this->height = height;
+    }
+
+
+    HashLifeField::Node* HashLifeField::fillNode(Node* node, int64_t x, int64_t y, const function<bool(int64_t, int64_t)>& func) {
+        const int64_t size = (int64_t)1 << node->level;
+
+        if(x >= width || y >= height || x + size <= 0 || y + size <= 0)
+            return node;
+
+        if(node->level == 0)
+            return func(x, y) ? &aliveLeaf : &deadLeaf;
+
+        const int64_t half = size / 2;
+
+        return join(
+                fillNode(node->nw, x, y, func),        fillNode(node->ne, x + half, y, func),
+                fillNode(node->sw, x, y + half, func), fillNode(node->se, x + half, y + half, func)
+        );
+    }
+
+    void HashLifeField::fillVisible(function<bool(int64_t, int64_t)> func) {
+        while(rootHalf() < max(width, height))
+            root = expand(root);
+
+        root = fillNode(root, -rootHalf(), -rootHalf(), func);
+
+        if(getMemoryUsage() > memoryLimit)
+            collectGarbage();
+    }
+
+    void HashLifeField::fillRandom() {
+        fillVisible([] (int64_t x, int64_t y) {
+            return ((rand() * (int)x * (int)y / 2) & CELL_ON) != 0;
+        });
+    }
+
+    void HashLifeField::clear() {
+        fillVisible([] (int64_t, int64_t) { return false; });
+    }
+
+    void HashLifeField::fill() {
+        fillVisible([] (int64_t, int64_t) { return true; });
+    }
+
+
+    void HashLifeField::forEachOn(const Node* node, int64_t x, int64_t y, int64_t startX, int64_t startY, int64_t endX, int64_t endY,
+                                  const function<void(int, int)>& func) const {
+
+        const int64_t size = (int64_t)1 << node->level;
+
+        if(node->population == 0 || x >= endX || y >= endY || x + size <= startX || y + size <= startY)
+            return;
+
+        if(node->level == 0) {
+            func(x, y);
+            return;
+        }
+
+        const int64_t half = size / 2;
+
+        forEachOn(node->nw, x,        y,        startX, startY, endX, endY, func);
+        forEachOn(node->sw, x,        y + half, startX, startY, endX, endY, func);
+        forEachOn(node->ne, x + half, y,        startX, startY, endX, endY, func);
+        forEachOn(node->se, x + half, y + half, startX, startY, endX, endY, func);
+    }
+
+    void HashLifeField::forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const {
+        forEachOn(root, -rootHalf(), -rootHalf(), startX, startY, endX, endY, func);
+    }
+
+    uint32_t HashLifeField::countBlocks(const Node* node, int64_t x, int64_t y, int64_t startX, int64_t startY, int64_t endX, int64_t endY,
+                                        uint8_t* counts, int countsHeight) const {
+
+        const int64_t size = (int64_t)1 << node->level;
+
+        if(node->population == 0 || x >= endX || y >= endY || x + size <= startX || y + size <= startY)
+            return 0;
+
+        // Узел уровня 1 целиком внутри прямоугольника - это ровно один блок 2x2
+        if(node->level <= 1 && x >= startX && y >= startY && x + size <= endX && y + size <= endY) {
+            counts[(x - startX) / 2 * countsHeight + (y - startY) / 2] += node->population;
+            return node->population;
+        }
+
+        const int64_t half = size / 2;
+
+        return countBlocks(node->nw, x,        y,        startX, startY, endX, endY, counts, countsHeight) +
+               countBlocks(node->sw, x,        y + half, startX, startY, endX, endY, counts, countsHeight) +
+               countBlocks(node->ne, x + half, y,        startX, startY, endX, endY, counts, countsHeight) +
+               countBlocks(node->se, x + half, y + half, startX, startY, endX, endY, counts, countsHeight);
+    }
+
+    uint32_t HashLifeField::countBlocks(int startX, int startY, int endX, int endY, uint8_t* counts, int countsHeight) const {
+        return countBlocks(root, -rootHalf(), -rootHalf(), startX, startY, endX, endY, counts, countsHeight);
+    }
+}
+
+#endif // LIFEGAME_HASH_LIFE_FIELD_CPP
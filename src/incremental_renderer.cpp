@@ -0,0 +1,100 @@
+#ifndef LIFEGAME_INCREMENTAL_RENDERER_CPP
+#define LIFEGAME_INCREMENTAL_RENDERER_CPP
+
+#include <algorithm>
+#include "incremental_renderer.h"
+#include "cell.h"
+
+namespace lifegame {
+
+    static inline void addQuad(VertexArray& quads, float left, float top, float right, float bottom, Color color) {
+        quads.append(Vertex(Vector2f(left,  top),    color));
+        quads.append(Vertex(Vector2f(right, top),    color));
+        quads.append(Vertex(Vector2f(right, bottom), color));
+        quads.append(Vertex(Vector2f(left,  bottom), color));
+    }
+
+    void IncrementalRenderer::addTile(const Snapshot& snapshot, int tileX, int tileY, int width, int height) {
+        const int
+                startX = tileX * Snapshot::TILE_SIZE,
+                startY = tileY * Snapshot::TILE_SIZE,
+                endX = std::min(startX + Snapshot::TILE_SIZE, width),
+                endY = std::min(startY + Snapshot::TILE_SIZE, height);
+
+        if(startX >= endX || startY >= endY)
+            return;
+
+        // Стираем плитку вместе с сеткой, затем рисуем живые клетки поверх
+        addQuad(quads, startX * CELL_SIZE, startY * CELL_SIZE, endX * CELL_SIZE, endY * CELL_SIZE, Color::Black);
+
+        const float size = CELL_SIZE - 1;
+
+        for(int x = startX; x < endX; ++x) {
+            const char* const column = &snapshot.cells[(size_t)x * snapshot.height];
+            const float left = x * CELL_SIZE;
+
+            for(int y = startY; y < endY; ++y) {
+                if(column[y]) {
+                    const float top = y * CELL_SIZE;
+                    addQuad(quads, left, top, left + size, top + size, Color::White);
+                }
+            }
+        }
+    }
+
+    void IncrementalRenderer::update(const Snapshot& snapshot, int width, int height) {
+        quads.clear();
+
+        // Плитки снимка можно дорисовать, только если предыдущий снимок нарисован целиком в том же масштабе.
+        // Иначе (поток отрисовки пропустил снимок, изменился масштаб или размер) перерисовываются все плитки
+        if(CELL_SIZE == lastCellSize && width == lastWidth && height == lastHeight &&
+           snapshot.dirtySince != 0 && snapshot.dirtySince == lastSerial) {
+
+            for(int tile : snapshot.dirtyTiles) {
+                addTile(snapshot, tile / snapshot.tilesHeight(), tile % snapshot.tilesHeight(), width, height);
+            }
+
+        } else {
+            const unsigned pixelsWidth = width * CELL_SIZE, pixelsHeight = height * CELL_SIZE;
+
+            if(canvas.getSize() != Vector2u(pixelsWidth, pixelsHeight)) {
+                canvas.create(pixelsWidth, pixelsHeight);
+                canvasSprite.setTexture(canvas.getTexture(), true);
+            }
+
+            canvas.clear();
+
+            for(int tileX = 0, tilesWidth = snapshot.tilesWidth(); tileX < tilesWidth; ++tileX) {
+                for(int tileY = 0, tilesHeight = snapshot.tilesHeight(); tileY < tilesHeight; ++tileY) {
+                    addTile(snapshot, tileX, tileY, width, height);
+                }
+            }
+        }
+
+        if(quads.getVertexCount() != 0)
+            canvas.draw(quads);
+
+        canvas.display();
+    }
+
+    void IncrementalRenderer::draw(RenderTarget& target, const Snapshot& snapshot, int width, int height) {
+        width = std::min(width, snapshot.width);
+        height = std::min(height, snapshot.height);
+
+        if(width <= 0 || height <= 0)
+            return;
+
+        if(snapshot.serial != lastSerial || CELL_SIZE != lastCellSize || width != lastWidth || height != lastHeight) {
+            update(snapshot, width, height);
+
+            lastSerial = snapshot.serial;
+            lastCellSize = CELL_SIZE;
+            lastWidth = width;
+            lastHeight = height;
+        }
+
+        target.draw(canvasSprite);
+    }
+}
+
+#endif // LIFEGAME_INCREMENTAL_RENDERER_CPP
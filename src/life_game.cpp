@@ -2,14 +2,30 @@
 #define LIFE_GAME_CPP
 
 #include "life_game.h"
+#include <cstdio>
+#include <stdexcept>
 
 namespace lifegame {
 
     const duration
-            LifeGame::MAX_SLEEP_TIME = 100ms,
             LifeGame::MIN_DELAY        = 0x004ms,
             LifeGame::MAX_DELAY        = 0x400ms,
-            LifeGame::MIN_RENDER_DELAY = 0x020ms;
+            LifeGame::MIN_RENDER_DELAY = 0x010ms,
+            LifeGame::PROGRESS_DELAY   = 0x100ms;
+
+    #ifdef PROFILE
+    const duration LifeGame::PROFILE_UPDATE_DELAY = 500ms;
+    #endif // PROFILE
+
+    // Высота справки при масштабе 16: по 20 пикселей на строку
+    static const float HELP_HEIGHT = 370
+            #ifdef PROFILE
+            + 20
+            #endif // PROFILE
+            #ifdef TRACE
+            + 20
+            #endif // TRACE
+            ;
 
     const vector<Rules> LifeGame::RULES = {
         { makeRule(3),          makeRule(2, 3) },
@@ -18,20 +34,28 @@ namespace lifegame {
         { makeRule(1),          makeRule(0, 1, 2, 3, 4, 5, 6, 7, 8) }
     };
 
-    LifeGame::LifeGame(VideoMode videoMode, bool fullscreen, string defaultFontName):
-            dataWidth(widthOf(videoMode.width)), dataHeight(heightOf(videoMode.height)),
-            width(dataWidth), height(dataHeight),
-            data(new_2d_array<Cell>(width + 2, height + 2, 1, CELL_OFF)), // Резервируем область шириной в 1 клетку вокруг поля
+    LifeGame::LifeGame(VideoMode videoMode, bool fullscreen, string defaultFontName, string fieldType, unsigned threadsCount,
+                       string rendererType):
+            width(widthOf(videoMode.width)), height(heightOf(videoMode.height)),
+            field(Field::create(fieldType, width, height)),
+            threadPool(threadsCount),
             window(videoMode, TITLE, fullscreen ? Style::Fullscreen : Style::Default),
             fullscreen(fullscreen),
+            renderer(Renderer::create(rendererType)),
 
             defaultTextFont(loadFont(defaultFontName)),
             pausedText(defaultText(14)),
             rulesText(defaultText(27)),
             checkZoneText(defaultText(23)),
+            topologyText(defaultText(17)),
             speedText(defaultText(12)),
             scaleText(defaultText(10)),
-            helpElement(Vector2f(window.getSize()), Vector2f(270.f / 16 * CELL_SIZE, 300.f / 16 * CELL_SIZE), {
+            generationText(defaultText(24)),
+            cycleText(defaultText(32)),
+            #ifdef PROFILE
+            profileText(defaultText(72)),
+            #endif // PROFILE
+            helpElement(Vector2f(window.getSize()), Vector2f(270.f / 16 * CELL_SIZE, HELP_HEIGHT / 16 * CELL_SIZE), {
                     defaultText(0, 0, "F1 - this help"),
                     defaultText(0, 0, "P - pause"),
                     defaultText(0, 0, "Esc - exit"),
@@ -41,29 +65,96 @@ namespace lifegame {
                     defaultText(0, 0, "R - fill screen randomly"),
                     defaultText(0, 0, "1, 2, 3, 4 - change rules"),
                     defaultText(0, 0, "Z - change check zone"),
+                    defaultText(0, 0, "T - change topology"),
+                    defaultText(0, 0, "G - jump to generation"),
+                    defaultText(0, 0, "D - change action on cycle"),
+                    #ifdef PROFILE
+                    defaultText(0, 0, "F2 - profiling info"),
+                    #endif // PROFILE
+                    #ifdef TRACE
+                    defaultText(0, 0, "F3 - write trace"),
+                    #endif // TRACE
                     defaultText(0, 0, "LMB - draw"),
                     defaultText(0, 0, "RMB - erase"),
+                    defaultText(0, 0, "MMB, Shift+arrows - move"),
                     defaultText(0, 0, "Wheel up - increase speed"),
                     defaultText(0, 0, "Wheel down - reduce speed"),
             }) {
 
+        field->setThreadPool(&threadPool);
+
         setPause(true);
         setRules(&RULES[0]);
         setCheckZone(&CheckZone::QUAD);
+        setTopology(TOPOLOGY_PLANE);
         setDelay(64ms);
         setScale(DEFAULT_CELL_SIZE);
     }
 
     LifeGame::~LifeGame() {
-        delete[] (data - 1);
+        delete renderer;
+        delete field;
     }
 
     int LifeGame::widthOf(int width) {
-        return width / CELL_SIZE;
+        return lodLevel > 0 ? width << (lodLevel - 1) : width / CELL_SIZE;
     }
 
     int LifeGame::heightOf(int height) {
-        return (height - TOOLBAR_HEIGHT) / CELL_SIZE;
+        height -= TOOLBAR_HEIGHT;
+        return lodLevel > 0 ? height << (lodLevel - 1) : height / CELL_SIZE;
+    }
+
+    Vector2i LifeGame::getFieldSize() const {
+        if(fieldWidth != 0 && fieldHeight != 0)
+            return Vector2i(fieldWidth, fieldHeight);
+
+        return Vector2i(window.getSize().x / CELL_SIZE, (window.getSize().y - TOOLBAR_HEIGHT) / CELL_SIZE);
+    }
+
+    void LifeGame::resizeView() {
+        const int centerX = viewX + width / 2, centerY = viewY + height / 2;
+
+        width = widthOf(window.getSize().x);
+        height = heightOf(window.getSize().y);
+
+        if(fieldWidth == 0 || fieldHeight == 0) {
+            const Vector2i fieldSize = getFieldSize();
+            resizeField(fieldSize.x, fieldSize.y);
+        }
+
+        moveView(centerX - width / 2, centerY - height / 2);
+    }
+
+    void LifeGame::resizeField(int width, int height) {
+        post([this, width, height] () {
+            field->resize(width, height);
+            resetCycle();
+        });
+    }
+
+    void LifeGame::moveView(int x, int y) {
+        const Vector2i fieldSize = getFieldSize();
+        const int blockSize = lodLevel > 0 ? 1 << (lodLevel - 1) : 1;
+
+        // Неограниченное поле можно смотреть где угодно. Видимая часть ограниченного поля остаётся в нём,
+        // а в уменьшенном виде может быть больше поля, тогда поле показывается от угла (0, 0)
+        if(!field->isUnbounded()) {
+            x = max(min(x, fieldSize.x - width), 0);
+            y = max(min(y, fieldSize.y - height), 0);
+        }
+
+        // В уменьшенном виде угол выравнивается на блок, чтобы блоки совпадали с уровнем пирамиды
+        viewX = x - ((x % blockSize) + blockSize) % blockSize;
+        viewY = y - ((y % blockSize) + blockSize) % blockSize;
+
+        post([this, viewport = IntRect(viewX, viewY, width, height), level = lodLevel - 1] () {
+            this->viewport = viewport;
+            snapshotLevel = level;
+
+            if(level < 0)
+                mipmap.clear();
+        });
     }
 
     Text LifeGame::defaultText(int x, int y, string content) {
@@ -119,36 +210,119 @@ namespace lifegame {
     }
 
 
+    void LifeGame::post(function<void()> command) {
+        {
+            lock_guard<mutex> lock(commandsMutex);
+            commands.push_back(std::move(command));
+        }
+
+        commandsCondition.notify_one();
+    }
+
     void LifeGame::setPause(bool paused) {
-        this->paused = paused;
-        pausedText.setString(paused ? "paused" : "not paused");
+        {
+            lock_guard<mutex> lock(commandsMutex);
+            this->paused = paused;
+        }
+
+        commandsCondition.notify_one();
     }
 
     void LifeGame::setRules(const Rules* rules) {
-        this->rules = rules;
         rulesText.setString("rules: " + rules->name);
+
+        post([this, rules] () {
+            this->rules = rules;
+            resetCycle();
+        });
     }
 
     void LifeGame::setCheckZone(const CheckZone* checkZone) {
-        this->checkZone = checkZone;
         checkZoneText.setString("check zone: " + checkZone->name);
+
+        post([this, checkZone] () {
+            this->checkZone = checkZone;
+            resetCycle();
+        });
+    }
+
+    void LifeGame::setTopology(Topology topology) {
+        // Проверяется до отправки команды, иначе надпись и поле разойдутся
+        if(!field->supportsTopology(topology))
+            throw std::invalid_argument(string("Field does not support topology \"") + TOPOLOGY_NAMES[topology] + "\"");
+
+        this->topology = topology;
+        topologyText.setString(string("topology: ") + TOPOLOGY_NAMES[topology]);
+
+        post([this, topology] () {
+            field->setTopology(topology);
+            resetCycle();
+        });
+    }
+
+    void LifeGame::setCycleAction(CycleAction cycleAction) {
+        this->cycleAction = cycleAction;
+
+        post([this] () {
+            resetCycle();
+        });
+    }
+
+    void LifeGame::resetCycle() {
+        cycleDetector.reset();
+        idle = false;
+    }
+
+    void LifeGame::checkCycle() {
+        if(cycleAction == CYCLE_OFF || cycleDetector.hasCycle())
+            return;
+
+        PROFILE_SCOPE(profiler, PHASE_CYCLE);
+        TRACE_SCOPE("cycle");
+
+        const uint64_t hash = field->hash(),
+                       distance = cycleDetector.add(generation, hash);
+
+        if(distance == 0)
+            return;
+
+        // Поколения проверяются пачками, поэтому расстояние лишь кратно периоду.
+        // Период уточняется по одному поколению: если за distance - 1 шагов состояние не повторилось, он равен distance
+        uint64_t period = distance, steps = 0;
+
+        while(steps + 1 < distance) {
+            field->step(*rules, *checkZone);
+            ++steps;
+
+            if(field->hash() == hash) {
+                period = steps;
+                break;
+            }
+        }
+
+        setGeneration(generation + steps);
+        cycleDetector.setPeriod(period);
+
+        if(cycleAction == CYCLE_PAUSE) {
+            setPause(true);
+        } else if(cycleAction == CYCLE_IDLE) {
+            idle = true;
+        }
     }
 
     void LifeGame::setDelay(duration delay) {
-        this->delay = min(max(delay, MIN_DELAY), MAX_DELAY);
-        speedText.setString("speed: " + to_string(MAX_DELAY.count() / this->delay.count()));
+        delay = min(max(delay, MIN_DELAY), MAX_DELAY);
+        this->delay = delay;
+        speedText.setString("speed: " + to_string(MAX_DELAY.count() / delay.count()));
     }
 
     void LifeGame::setScale(int scale) {
         scale = min(max(scale, MIN_CELL_SIZE), MAX_CELL_SIZE);
 
-        float multiplier = (float)scale / CELL_SIZE;
-
-        width /= multiplier;
-        height /= multiplier;
-        extendDataIfNecessary();
-
         CELL_SIZE = scale;
+        lodLevel = 0;
+        resizeView();
+
         Vector2f newCellSize(CELL_SIZE - 1, CELL_SIZE - 1);
         Cell::whiteCellShape.setSize(newCellSize);
         Cell::blackCellShape.setSize(newCellSize);
@@ -156,155 +330,178 @@ namespace lifegame {
         scaleText.setString("scale: " + fp_to_string((float)CELL_SIZE / DEFAULT_CELL_SIZE));
     }
 
+    void LifeGame::setLodLevel(int level) {
+        level = min(max(level, 0), MAX_LOD_LEVEL);
+
+        if(level == 0) {
+            setScale(CELL_SIZE);
+            return;
+        }
+
+        lodLevel = level;
+        resizeView();
+
+        scaleText.setString("scale: 1/" + to_string(DEFAULT_CELL_SIZE << (lodLevel - 1)));
+    }
+
+    void LifeGame::setFieldSize(int width, int height) {
+        fieldWidth = max(width, 0);
+        fieldHeight = max(height, 0);
+
+        if(fieldWidth != 0 && fieldHeight != 0)
+            resizeField(fieldWidth, fieldHeight);
+
+        resizeView();
+    }
+
     void LifeGame::incScale(int extent) {
+        if(lodLevel > 0 || (extent < 0 && CELL_SIZE == MIN_CELL_SIZE)) {
+            setLodLevel(lodLevel - extent);
+            return;
+        }
+
         float multiplier = pow(2, extent);
         setScale(CELL_SIZE * multiplier);
     }
 
 
-    void LifeGame::forEachCell(function<void(int, int, Cell&)> func) {
-        forEachCell(0, 0, width, height, func);
+    void LifeGame::fillRandom() {
+        post([this] () {
+            field->fillRandom();
+            setGeneration(0);
+            resetCycle();
+        });
     }
 
-    void LifeGame::forEachCell(int startX, int startY, int endX, int endY, function<void(int, int, Cell&)> func) {
-        auto data = this->data;
-
-        for(int x = startX; x < endX; ++x) {
-            Cell* const row = data[x];
+    void LifeGame::clear() {
+        post([this] () {
+            field->clear();
+            setGeneration(0);
+            resetCycle();
+        });
+    }
 
-            for(int y = startY; y < endY; ++y) {
-                func(x, y, row[y]);
-            }
-        }
+    void LifeGame::fill() {
+        post([this] () {
+            field->fill();
+            setGeneration(0);
+            resetCycle();
+        });
     }
 
-    #ifdef DRAW_PARALLEL
-    void LifeGame::forEachCellParallel(function<void(int, int, Cell&)> parallelFunc, function<void(int, int, Cell&)> func) {
-        unsigned int processorsCount = thread::hardware_concurrency();
+    void LifeGame::jumpTo(uint64_t target) {
+        // Переход можно отменить, пока команда ещё ждёт в очереди
+        cancelAdvance = false;
+        advancing = true;
 
-        cout << "processorsCount = " << processorsCount << endl;
-        getchar();
+        post([this, target] () {
+            advance(target > generation ? target - generation : 0);
+        });
+    }
 
-        if(processorsCount > 1) {
-            unsigned int threadsCount = processorsCount - 1;
+    void LifeGame::setGeneration(uint64_t generation) {
+        this->generation = generation;
+    }
 
-            //vector<thread*> threads;
-            vector<future<void>> futures;
-            futures.reserve(threadsCount);
+    void LifeGame::updateJumpText() {
+        generationText.setString("jump to: " + jumpTarget + "_");
+    }
 
-            int partWidth = width / processorsCount,
-                height = this->height;
+    bool LifeGame::processJumpInput(Event& event) {
+        if(event.type == Event::TextEntered) {
+            const Uint32 c = event.text.unicode;
 
-            for(unsigned int i = 0; i < threadsCount; ++i) {
-                cout << "new thread" << endl;
-                getchar();
+            if(c >= '0' && c <= '9' && jumpTarget.size() < 19) {
+                jumpTarget += (char)c;
+                updateJumpText();
+            }
 
-                /*
-                threads.push_back(new thread([this, i, partWidth, height, &parallelFunc] () {
-                    forEachCell(i * partWidth, 0, (i + 1) * partWidth, height, parallelFunc);
-                }));
-                //*/
+            return true;
+        }
 
-                futures.push_back(async(launch::async, [this, i, partWidth, height, &parallelFunc] () {
-                    try {
-                        forEachCell(i * partWidth, 0, (i + 1) * partWidth, height, parallelFunc);
-                    } catch(std::exception& ex) {
-                        cout << ex.what() << endl;
-                        getchar();
-                        throw;
-                    }
-                }));
-            }
+        if(event.type != Event::KeyPressed)
+            return false;
 
-            cout << "threads started" << endl;
-            getchar();
+        // Остальные клавиши во время ввода игнорируются
+        switch(event.key.code) {
+            case Keyboard::Enter:
+                jumpInput = false;
 
-            forEachCell(threadsCount * partWidth, 0, processorsCount * partWidth, height, func);
+                if(!jumpTarget.empty())
+                    jumpTo(std::stoull(jumpTarget));
 
-            /*
-            for(thread* thrd : threads) {
-                //cout << "join thread" << endl;
-                //getchar();
+                break;
 
-                thrd->join();
-                delete thrd;
-            }
-            //*/
+            case Keyboard::Escape:
+                jumpInput = false;
+                break;
 
-            for(future<void>& fut : futures) {
-                fut.wait();
-            }
+            case Keyboard::Backspace:
+                if(!jumpTarget.empty())
+                    jumpTarget.pop_back();
 
-            cout << "threads joined" << endl;
-            getchar();
+                updateJumpText();
+                break;
 
-        } else {
-            forEachCell(func);
+            default:
+                break;
         }
+
+        return true;
     }
-    #endif // DRAW_PARALLEL
 
-    void LifeGame::extendDataIfNecessary() {
-        if(width > dataWidth || height > dataHeight) {
-            Cell
-                *const *const oldData = this->data,
-                *const *const newData = new_2d_array<Cell>(width + 2, height + 2, 1, CELL_OFF);
+    #ifdef PROFILE
+    void LifeGame::updateProfileText() {
+        const time_point now = clock::now();
 
-            for(int x = 0, dataWidth = this->dataWidth; x < dataWidth; ++x) {
-                Cell
-                    *const oldRow = oldData[x],
-                    *const newRow = newData[x];
+        if(now - profileTimePoint < PROFILE_UPDATE_DELAY)
+            return;
 
-                for(int y = 0, dataHeight = this->dataHeight; y < dataHeight; ++y) {
-                    newRow[y] = oldRow[y];
-                }
-            }
+        const double seconds = std::chrono::duration<double>(now - profileTimePoint).count();
+        char buffer[128];
 
-            data = newData;
-            dataWidth = width;
-            dataHeight = height;
-        }
-    }
+        switch(profileView) {
+            case PROFILE_SUMMARY: {
+                const Snapshot& snapshot = snapshots.getFront();
 
-    void LifeGame::clearBorder() {
-        int endX = width + 1,
-            endY = height + 1;
+                int length = snprintf(buffer, sizeof(buffer), "%.0f gen/s, frame %.1f/%.1f ms, population %llu",
+                                      profileGenerations / seconds,
+                                      profiler.percentile(PHASE_FRAME, 50), profiler.percentile(PHASE_FRAME, 99),
+                                      (unsigned long long)snapshot.population);
 
-        for(int x = -1; x < endX; ++x) {
-            Cell *const border = data[x];
+                if(snapshot.tilesCount != 0)
+                    snprintf(buffer + length, sizeof(buffer) - length, ", tiles %d/%d", snapshot.activeTiles, snapshot.tilesCount);
 
-            border[-1].off();
-            border[endY].off();
-        }
+                break;
+            }
 
-        Cell *const leftBorder = data[-1],
-             *const rightBorder = data[width];
+            case PROFILE_PHASES: {
+                // p50/p99 в миллисекундах
+                int length = 0;
 
-        for(int y = 0, height = this->height; y < height; ++y) {
-            leftBorder[y].off();
-            rightBorder[y].off();
-        }
-    }
+                for(int phase = 0; phase < PHASE_FRAME; ++phase) {
+                    length += snprintf(buffer + length, sizeof(buffer) - length, "%s%s %.1f/%.1f", phase == 0 ? "" : " ",
+                                       PHASE_NAMES[phase], profiler.percentile((ProfilePhase)phase, 50), profiler.percentile((ProfilePhase)phase, 99));
+                }
 
-    void LifeGame::fillRandom() {
-        forEachCell([] (int x, int y, Cell& cell) {
-            cell = (rand() * x * y / 2) & CELL_ON;
-        });
-    }
+                break;
+            }
 
-    void LifeGame::clear() {
-        forEachCell([] (int x, int y, Cell& cell) {
-            cell.off();
-        });
-    }
+            default:
+                buffer[0] = '\0';
+                break;
+        }
 
-    void LifeGame::fill() {
-        forEachCell([] (int x, int y, Cell& cell) {
-            cell.on();
-        });
+        profileText.setString(buffer);
+        profileGenerations = 0;
+        profileTimePoint = now;
     }
+    #endif // PROFILE
 
     bool LifeGame::processEvent(Event& event) {
+        if(jumpInput && processJumpInput(event))
+            return true;
+
         switch(event.type) {
             case Event::Closed:
                 window.close();
@@ -312,8 +509,7 @@ namespace lifegame {
 
             case Event::Resized:
                 window.setView(View(FloatRect(0, 0, event.size.width, event.size.height)));
-                width = widthOf(event.size.width);
-                height = heightOf(event.size.height);
+                resizeView();
 
                 for(Text* text : texts) {
                     text->setPosition(text->getPosition().x, event.size.height - TOOLBAR_TEXT_OFFSET);
@@ -326,7 +522,9 @@ namespace lifegame {
                 switch(event.key.code) {
                     case Keyboard::Escape:
 
-                        if(!helpElement.isHidden()) {
+                        if(advancing) {
+                            cancelAdvance = true;
+                        } else if(!helpElement.isHidden()) {
                             helpElement.hide();
                         } else {
                             window.close();
@@ -340,8 +538,18 @@ namespace lifegame {
                         break;
 
                     case Keyboard::F2:
+                        #ifdef PROFILE
+                        profileView = (ProfileView)((profileView + 1) % PROFILE_VIEWS);
+                        profileTimePoint = clock::now() - PROFILE_UPDATE_DELAY; // Обновить сразу
+                        #endif // PROFILE
                         break;
 
+                    #ifdef TRACE
+                    case Keyboard::F3:
+                        Tracer::dump();
+                        return false;
+                    #endif // TRACE
+
                     case Keyboard::F11: {
                         Vector2u size = window.getSize();
                         window.create(VideoMode(size.x, size.y), TITLE, fullscreen ? Style::Default : Style::Fullscreen);
@@ -363,23 +571,63 @@ namespace lifegame {
 
                     case Keyboard::Space:
                         setPause(!paused);
-
-                        if(!paused) { // reset time point
-                            renderTimePoint = timePoint = clock::now();
-                        }
-
                         break;
 
                     case Keyboard::Z:
                         setCheckZone(CheckZone::checkZones[checkZoneIndex = (checkZoneIndex + 1) % CheckZone::checkZones.size()]);
                         break;
 
+                    case Keyboard::T: {
+                        Topology topology = this->topology;
+
+                        do {
+                            topology = (Topology)((topology + 1) % TOPOLOGIES);
+                        } while(!field->supportsTopology(topology));
+
+                        setTopology(topology);
+                        break;
+                    }
+
+                    case Keyboard::D:
+                        setCycleAction((CycleAction)((cycleAction + 1) % CYCLE_ACTIONS));
+                        break;
+
+                    case Keyboard::G:
+                        jumpInput = true;
+                        jumpTarget.clear();
+                        updateJumpText();
+                        break;
+
                     case Keyboard::Up:
-                        setDelay(delay / 2);
+                        if(event.key.shift) {
+                            moveView(viewX, viewY - height / 4);
+                        } else {
+                            setDelay(delay.load() / 2);
+                        }
+
                         break;
 
                     case Keyboard::Down:
-                        setDelay(delay * 2);
+                        if(event.key.shift) {
+                            moveView(viewX, viewY + height / 4);
+                        } else {
+                            setDelay(delay.load() * 2);
+                        }
+
+                        break;
+
+                    case Keyboard::Left:
+                        if(!event.key.shift)
+                            return false;
+
+                        moveView(viewX - width / 4, viewY);
+                        break;
+
+                    case Keyboard::Right:
+                        if(!event.key.shift)
+                            return false;
+
+                        moveView(viewX + width / 4, viewY);
                         break;
 
                     default:
@@ -395,7 +643,8 @@ namespace lifegame {
                 break;
 
             case Event::MouseButtonPressed:
-                if(event.mouseButton.button == Mouse::Left || event.mouseButton.button == Mouse::Right) {
+                // В уменьшенном виде пиксель - блок клеток, рисовать в нём нельзя
+                if(lodLevel == 0 && (event.mouseButton.button == Mouse::Left || event.mouseButton.button == Mouse::Right)) {
                     userDrawingPos.x = event.mouseButton.x;
                     userDrawingPos.y = event.mouseButton.y;
                     userErasing = event.mouseButton.button == Mouse::Right;
@@ -404,12 +653,27 @@ namespace lifegame {
                         y = event.mouseButton.y / CELL_SIZE;
 
                     if(x >= 0 && x < width && y >= 0 && y < height) {
-                        data[x][y] = userErasing ? CELL_OFF : CELL_ON;
+                        x += viewX;
+                        y += viewY;
+
+                        post([this, x, y, on = !userErasing] () {
+                            if(field->isUnbounded() || (x < field->getWidth() && y < field->getHeight())) {
+                                field->set(x, y, on);
+                                resetCycle();
+                            }
+                        });
                     }
 
                     break;
                 }
 
+                if(event.mouseButton.button == Mouse::Middle) {
+                    panningPos.x = event.mouseButton.x;
+                    panningPos.y = event.mouseButton.y;
+                    panningView.x = viewX;
+                    panningView.y = viewY;
+                }
+
                 return false;
 
             case Event::MouseButtonReleased:
@@ -418,23 +682,52 @@ namespace lifegame {
                     userErasing = false;
                 }
 
+                if(event.mouseButton.button == Mouse::Middle)
+                    panningPos.x = panningPos.y = -1;
+
                 return false;
 
             case Event::MouseMoved:
+                if(panningPos.x >= 0 && panningPos.y >= 0) {
+                    // Поле движется вслед за мышью
+                    const Vector2i offset = panningPos - Vector2i(event.mouseMove.x, event.mouseMove.y);
+
+                    if(lodLevel > 0) {
+                        moveView(panningView.x + offset.x * (1 << (lodLevel - 1)), panningView.y + offset.y * (1 << (lodLevel - 1)));
+                    } else {
+                        moveView(panningView.x + offset.x / CELL_SIZE, panningView.y + offset.y / CELL_SIZE);
+                    }
+
+                    break;
+                }
+
                 if(userDrawingPos.x >= 0 && userDrawingPos.y >= 0) {
+                    const Vector2i mousePos(event.mouseMove.x, event.mouseMove.y);
 
-                    forEachCell(
-                            min(userDrawingPos.x, event.mouseMove.x) / CELL_SIZE,     min(userDrawingPos.y, event.mouseMove.y) / CELL_SIZE,
-                            max(userDrawingPos.x, event.mouseMove.x) / CELL_SIZE + 1, max(userDrawingPos.y, event.mouseMove.y) / CELL_SIZE + 1,
-                            [this, &event] (int x, int y, Cell& cell) {
-                                if(x >= 0 && x < width && y >= 0 && y < height &&
-                                        cell.intersectsWith(userDrawingPos, Vector2i(event.mouseMove.x, event.mouseMove.y), x, y)) {
+                    const int
+                            startX = max(min(userDrawingPos.x, mousePos.x) / CELL_SIZE, 0),
+                            startY = max(min(userDrawingPos.y, mousePos.y) / CELL_SIZE, 0),
+                            endX = min(max(userDrawingPos.x, mousePos.x) / CELL_SIZE + 1, width),
+                            endY = min(max(userDrawingPos.y, mousePos.y) / CELL_SIZE + 1, height);
 
-                                    cell = userErasing ? CELL_OFF : CELL_ON;
-                                    cell.draw(window, x, y);
-                                }
-                            }
-                    );
+                    vector<Vector2i> cells;
+
+                    for(int x = startX; x < endX; ++x) {
+                        for(int y = startY; y < endY; ++y) {
+                            if(Cell::intersectsWith(userDrawingPos, mousePos, x, y))
+                                cells.emplace_back(x + viewX, y + viewY);
+                        }
+                    }
+
+                    // Размер поля мог измениться, пока команда ждала в очереди
+                    post([this, cells = std::move(cells), on = !userErasing] () {
+                        for(const Vector2i& cell : cells) {
+                            if(field->isUnbounded() || (cell.x < field->getWidth() && cell.y < field->getHeight()))
+                                field->set(cell.x, cell.y, on);
+                        }
+
+                        resetCycle();
+                    });
 
                     userDrawingPos.x = event.mouseMove.x;
                     userDrawingPos.y = event.mouseMove.y;
@@ -460,162 +753,308 @@ namespace lifegame {
     }
 
     bool LifeGame::processEvents() {
-        Event event;
+        PROFILE_SCOPE(profiler, PHASE_EVENTS);
+        TRACE_SCOPE("events");
 
-        bool eventProcessed = false, needRedraw = false;
+        Event event;
+        bool needRedraw = false;
 
         while(window.pollEvent(event)) {
-
             needRedraw |= processEvent(event);
-            eventProcessed = true;
         }
 
-        if(needRedraw)
-            drawAll();
-
-        return eventProcessed;
+        return needRedraw;
     }
 
     void LifeGame::run() {
+        #ifdef TRACE
+        Tracer::setThreadName("main");
+        #endif // TRACE
+
+        simulation = std::thread(&LifeGame::simulate, this);
+
         drawAll();
 
         while(window.isOpen()) {
             iteration();
         }
+
+        {
+            lock_guard<mutex> lock(commandsMutex);
+            stopping = true;
+        }
+
+        cancelAdvance = true;
+        commandsCondition.notify_one();
+        simulation.join();
+
+        #ifdef TRACE
+        Tracer::dump();
+        #endif // TRACE
     }
 
-    void LifeGame::iteration() {
-         #ifdef DEBUG
-        static uint64_t tolalTicks = 0;
-        static uint32_t tolalSteps = 0;
-        #endif // DEBUG
-
-        if(paused) {
-            this_thread::sleep_for(MAX_SLEEP_TIME);
-            processEvents();
-
-             #ifdef DEBUG
-            if(tolalTicks != 0) {
-                uint64_t elapsed = tolalTicks / tolalSteps;
-                cout << "average: " << elapsed << " (" << elapsed / (1024.f * 1024.f) << " M)" << endl;
-                tolalTicks = 0;
-                tolalSteps = 0;
+    void LifeGame::simulate() {
+        #ifdef TRACE
+        Tracer::setThreadName("simulation");
+        #endif // TRACE
+
+        unique_lock<mutex> lock(commandsMutex);
+
+        while(!stopping) {
+            if(!commands.empty()) {
+                vector<function<void()>> pending;
+                pending.swap(commands);
+                lock.unlock();
+
+                for(const function<void()>& command : pending) {
+                    try {
+                        command();
+                    } catch(exception& ex) {
+                        reportError(ex);
+                    }
+                }
+
+                publish();
+                lock.lock();
+                continue;
             }
-            #endif // DEBUG
 
-        } else {
+            if(publishPending && acquiredSnapshot == publishedSnapshots) {
+                lock.unlock();
+                publish();
+                lock.lock();
+                continue;
+            }
 
-            #ifdef DEBUG
-            {
-                uint64_t start = rdtsc();
-                step();
-                uint64_t elapsed = rdtsc() - start;
-                //cout << "elapsed: " << elapsed << " (" << elapsed / (1024.f * 1024.f) << " M)" << endl;
-                tolalTicks += elapsed;
-                ++tolalSteps;
+            // Пока снимок отложен, поток просыпается с частотой кадров, чтобы опубликовать его, когда предыдущий заберут
+            if(paused || idle) {
+                if(publishPending) {
+                    commandsCondition.wait_for(lock, MIN_RENDER_DELAY);
+                } else {
+                    commandsCondition.wait(lock);
+                }
+
+                timePoint = clock::now();
+                continue;
             }
-            #else
-            step();
-            #endif // DEBUG
-
-            if(timePoint >= renderTimePoint) {
-                renderTimePoint += max(delay, MIN_RENDER_DELAY);
-                #ifdef TRY_OPTIMIZE_RENDER
-                window.display();
-                #else
-                drawAll();
-                #endif // TRY_OPTIMIZE_RENDER
+
+            if(clock::now() < timePoint) {
+                TRACE_SCOPE("sleep");
+                commandsCondition.wait_until(lock, publishPending ? min(timePoint, clock::now() + MIN_RENDER_DELAY) : timePoint);
+                continue;
             }
 
-            const time_point nextTimePoint = timePoint += delay;
+            lock.unlock();
+
+            // Промежуточные поколения между кадрами не отображаются, поэтому они считаются одним вызовом
+            const duration delay = this->delay;
+            const int generations = max<int>(MIN_RENDER_DELAY / delay, 1);
 
-            //cout << nextTimePoint.time_since_epoch().count() << endl;
+            try {
+                step(generations);
+                checkCycle();
+            } catch(exception& ex) {
+                reportError(ex);
+            }
 
-            while(true) {
-                const duration remainingTime = nextTimePoint - clock::now();
+            publish();
 
-                bool remainedFew = remainingTime <= MAX_SLEEP_TIME;
+            timePoint += delay * generations;
+            lock.lock();
+        }
+    }
 
-                this_thread::sleep_for(remainedFew ? remainingTime : MAX_SLEEP_TIME);
+    void LifeGame::reportError(const exception& ex) {
+        cerr << ex.what() << endl;
 
-                if(processEvents() && paused)
-                    return;
+        jumpProgress = -1;
+        advancing = false;
 
-                if(remainedFew)
-                    break;
+        lock_guard<mutex> lock(commandsMutex);
+        paused = true;
+    }
+
+    void LifeGame::publish() {
+        TRACE_SCOPE("publish");
+
+        publishPending = snapshotLevel >= 0 && acquiredSnapshot != publishedSnapshots;
+
+        if(publishPending)
+            return;
+
+        Snapshot& snapshot = snapshots.getBack();
+        snapshot.serial = ++publishedSnapshots;
+
+        if(snapshotLevel < 0) {
+            // В снимок попадает только видимая часть поля
+            snapshot.capture(*field, viewport.left, viewport.top, viewport.left + viewport.width, viewport.top + viewport.height);
+            changeTracker.track(snapshot, acquiredSnapshot);
+        } else {
+            // Клетки в снимок не копируются: поток отрисовки получает только видимую часть уровня пирамиды.
+            // Пирамида ограниченного поля покрывает всё поле, неограниченного - только видимую часть
+            int startX = viewport.left, startY = viewport.top;
+
+            if(field->isUnbounded()) {
+                snapshot.width = viewport.width;
+                snapshot.height = viewport.height;
+
+                mipmap.update(*field, snapshotLevel, startX, startY, snapshot.width, snapshot.height);
+            } else {
+                const int fieldWidth = field->getWidth(), fieldHeight = field->getHeight();
+
+                startX = min(startX, fieldWidth);
+                startY = min(startY, fieldHeight);
+                snapshot.width = min(viewport.width, fieldWidth - startX);
+                snapshot.height = min(viewport.height, fieldHeight - startY);
+
+                mipmap.update(*field, snapshotLevel, 0, 0, fieldWidth, fieldHeight);
             }
+
+            snapshot.blockSize = 1 << snapshotLevel;
+            snapshot.cells.clear();
+            snapshot.dirtyTiles.clear();
+            snapshot.dirtySince = 0;
+
+            mipmap.copyLevel(*field, snapshotLevel, startX, startY, snapshot.width, snapshot.height, snapshot.density);
+            snapshot.population = mipmap.getPopulation();
         }
+        snapshot.generation = generation;
+        snapshot.activeTiles = field->getActiveTilesCount();
+        snapshot.tilesCount = field->getTilesCount();
+        snapshot.cyclePeriod = cycleDetector.getPeriod();
+        snapshot.cycleStart = cycleDetector.getCycleStart();
+        snapshot.jumpProgress = jumpProgress;
+
+        snapshots.publish();
     }
 
-    void LifeGame::drawAll() {
-        window.clear();
+    void LifeGame::iteration() {
+        bool needRedraw = processEvents();
+
+        if(snapshots.acquire()) {
+            acquiredSnapshot = snapshots.getFront().serial;
+            needRedraw = true;
+        }
 
-        #ifdef DRAW_PARALLEL
-        mutex mtx;
+        if(needRedraw && window.isOpen()) {
+            PROFILE_SCOPE(profiler, PHASE_FRAME);
+            drawAll();
+        }
 
-        forEachCellParallel(
-                [this, &mtx] (int x, int y, Cell& cell) {
-                    if(cell.isOn())
-                        Cell::drawCellSynchronized(window, x, y, mtx);
-                },
+        // Окно перерисовывается не чаще раза в MIN_RENDER_DELAY, независимо от скорости симуляции
+        frameTimePoint = max(frameTimePoint + MIN_RENDER_DELAY, clock::now());
 
-                [this] (int x, int y, Cell& cell) {
-                    if(cell.isOn())
-                        Cell::drawCell(window, x, y);
-                }
-        );
-        #else
-        forEachCell([this] (int x, int y, Cell& cell) {
-            if(cell.isOn())
-                Cell::drawCell(window, x, y);
-        });
-        #endif // DRAW_PARALLEL
+        TRACE_SCOPE("sleep");
+        this_thread::sleep_until(frameTimePoint);
+    }
+
+    void LifeGame::updateTexts() {
+        const Snapshot& snapshot = snapshots.getFront();
+
+        pausedText.setString(paused ? "paused" : "not paused");
 
-        for(Text* text : texts) {
-            window.draw(*text);
+        if(!jumpInput) {
+            generationText.setString(snapshot.jumpProgress >= 0 ?
+                    "jump: " + to_string(snapshot.jumpProgress) + "%, Esc - cancel" :
+                    "generation: " + to_string(snapshot.generation));
         }
 
-        if(!helpElement.isHidden())
-            window.draw(helpElement);
+        cycleText.setString(snapshot.cyclePeriod != 0 ?
+                "period " + to_string(snapshot.cyclePeriod) + " since " + to_string(snapshot.cycleStart) :
+                string("on cycle: ") + CYCLE_ACTION_NAMES[cycleAction]);
+    }
 
-        #ifdef TRY_OPTIMIZE_RENDER
-        // Из-за двойной буферизации OpenGL приходится вызывать window.display()
-        // два раза, иначе отрисовывается предыдущий кадр
-        window.display();
-        window.display();
-        #else
+    void LifeGame::drawAll() {
+        TRACE_SCOPE("render");
+
+        #ifdef PROFILE
+        updateProfileText();
+        #endif // PROFILE
+
+        {
+            PROFILE_SCOPE(profiler, PHASE_DRAW);
+
+            window.clear();
+
+            const Snapshot& snapshot = snapshots.getFront();
+
+            (snapshot.blockSize != 0 ? &densityRenderer : renderer)->draw(window, snapshot, width, height);
+
+            updateTexts();
+
+            for(Text* text : texts) {
+                window.draw(*text);
+            }
+
+            if(!helpElement.isHidden())
+                window.draw(helpElement);
+        }
+
+        PROFILE_SCOPE(profiler, PHASE_DISPLAY);
         window.display();
-        #endif // TRY_OPTIMIZE_RENDER
     }
 
-    void LifeGame::step() {
-        //clearBorder();
+    void LifeGame::step(int generations) {
+        PROFILE_SCOPE(profiler, PHASE_STEP);
+        TRACE_SCOPE("step");
 
-        Cell* const* rowPtr = data;
+        #ifdef PROFILE
+        profileGenerations += generations;
+        #endif // PROFILE
 
-        for(int x = 1, width = this->width; x <= width; ++x, ++rowPtr) {
-            Cell
-                *prevRow = rowPtr[-1],
-                *currRow = rowPtr[0],
-                *nextRow = rowPtr[1];
+        // Состояние в цикле повторяется через период, поэтому достаточно вычислить остаток
+        const int computed = cycleAction == CYCLE_SKIP && cycleDetector.hasCycle() ?
+                generations % cycleDetector.getPeriod() : generations;
 
-            for(int y = 0; y < height; ++y, ++prevRow, ++currRow, ++nextRow) {
-                Cell& cell = currRow[0];
+        if(computed > 0)
+            field->step(*rules, *checkZone, computed);
 
-                if(rules->matches(cell, checkZone->countNeighbours(prevRow, currRow, nextRow))) {
-                    cell.setWillChange();
-                }
+        setGeneration(generation + generations);
+    }
+
+    uint64_t LifeGame::advance(uint64_t generations) {
+        uint64_t done = 0;
+        int batch = 1;
+        time_point progressTimePoint = clock::now() + PROGRESS_DELAY;
+
+        while(done < generations && !cancelAdvance) {
+            if(cycleAction == CYCLE_SKIP && cycleDetector.hasCycle()) {
+                const uint64_t remaining = generations - done;
+
+                field->step(*rules, *checkZone, remaining % cycleDetector.getPeriod());
+                setGeneration(generation + remaining);
+                done = generations;
+                break;
             }
-        }
 
-        forEachCell([this] (int x, int y, Cell& cell) {
-            if(cell.willChange()) {
-                cell.change();
-                #ifdef TRY_OPTIMIZE_RENDER
-                cell.draw(window, x, y);
-                #endif // TRY_OPTIMIZE_RENDER
+            const int count = (int)min<uint64_t>(batch, generations - done);
+            const time_point start = clock::now();
+
+            step(count);
+            checkCycle();
+            done += count;
+
+            const time_point now = clock::now();
+
+            // Пачка подбирается так, чтобы прогресс и отмена проверялись примерно раз в PROGRESS_DELAY
+            if(now - start < PROGRESS_DELAY / 4 && batch < MAX_ADVANCE_BATCH) {
+                batch *= 2;
+            } else if(now - start > PROGRESS_DELAY && batch > 1) {
+                batch /= 2;
             }
-        });
+
+            if(now >= progressTimePoint) {
+                progressTimePoint = now + PROGRESS_DELAY;
+                jumpProgress = (int)(done * 100.0 / generations);
+                publish();
+            }
+        }
+
+        jumpProgress = -1;
+        advancing = false;
+        timePoint = clock::now();
+
+        return done;
     }
 }
 
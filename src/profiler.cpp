@@ -0,0 +1,33 @@
+#ifndef LIFEGAME_PROFILER_CPP
+#define LIFEGAME_PROFILER_CPP
+
+#include "profiler.h"
+
+#ifdef PROFILE
+
+#include <algorithm>
+
+namespace lifegame {
+
+    const char* const PHASE_NAMES[PHASES] = { "events", "step", "cycle", "draw", "display", "frame" };
+
+    float Profiler::percentile(ProfilePhase phase, float percent) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        const Samples& phaseSamples = samples[phase];
+
+        if(phaseSamples.count == 0)
+            return 0;
+
+        float values[SAMPLES];
+        std::copy(phaseSamples.values, phaseSamples.values + phaseSamples.count, values);
+
+        float* const nth = values + std::min((int)(phaseSamples.count * percent / 100), phaseSamples.count - 1);
+        std::nth_element(values, nth, values + phaseSamples.count);
+
+        return *nth;
+    }
+}
+
+#endif // PROFILE
+
+#endif // LIFEGAME_PROFILER_CPP
@@ -0,0 +1,72 @@
+#ifndef LIFEGAME_RASTER_RENDERER_CPP
+#define LIFEGAME_RASTER_RENDERER_CPP
+
+#include <algorithm>
+#include "raster_renderer.h"
+#include "cell.h"
+
+namespace lifegame {
+
+    RasterRenderer::RasterRenderer(unsigned threadsCount):
+            threadPool(threadsCount) {}
+
+    void RasterRenderer::rasterize(const Snapshot& snapshot, int width, int startY, int endY) {
+        const size_t pixelsWidth = (size_t)width * CELL_SIZE;
+
+        for(int y = startY; y < endY; ++y) {
+            Uint32* const firstRow = &pixels[(size_t)y * CELL_SIZE * pixelsWidth];
+            Uint32* pixel = firstRow;
+
+            // Первая строка пикселей клеток: CELL_SIZE - 1 пикселей клетки и пиксель сетки
+            for(int x = 0; x < width; ++x) {
+                pixel = std::fill_n(pixel, CELL_SIZE - 1, snapshot.cells[(size_t)x * snapshot.height + y] ? PIXEL_ON : PIXEL_OFF);
+                *pixel++ = PIXEL_OFF;
+            }
+
+            // Остальные строки такие же, кроме последней - сетки
+            for(int row = 1; row < CELL_SIZE - 1; ++row) {
+                std::copy_n(firstRow, pixelsWidth, firstRow + row * pixelsWidth);
+            }
+
+            std::fill_n(firstRow + (CELL_SIZE - 1) * pixelsWidth, pixelsWidth, PIXEL_OFF);
+        }
+    }
+
+    void RasterRenderer::draw(RenderTarget& target, const Snapshot& snapshot, int width, int height) {
+        width = std::min(width, snapshot.width);
+        height = std::min(height, snapshot.height);
+
+        if(width <= 0 || height <= 0)
+            return;
+
+        if(snapshot.serial != lastSerial || CELL_SIZE != lastCellSize || width != lastWidth || height != lastHeight) {
+            const unsigned pixelsWidth = width * CELL_SIZE, pixelsHeight = height * CELL_SIZE;
+
+            if(texture.getSize() != Vector2u(pixelsWidth, pixelsHeight)) {
+                pixels.resize((size_t)pixelsWidth * pixelsHeight);
+                texture.create(pixelsWidth, pixelsHeight);
+                sprite.setTexture(texture, true);
+            }
+
+            const int
+                    bands = std::min<int>(threadPool.getThreadsCount() * BANDS_PER_THREAD, height),
+                    bandHeight = (height + bands - 1) / bands;
+
+            // Полосы не пересекаются, поэтому потоки пишут в pixels без синхронизации
+            threadPool.run(bands, [&] (int band) {
+                rasterize(snapshot, width, band * bandHeight, std::min((band + 1) * bandHeight, height));
+            });
+
+            texture.update(reinterpret_cast<const Uint8*>(pixels.data()));
+
+            lastSerial = snapshot.serial;
+            lastCellSize = CELL_SIZE;
+            lastWidth = width;
+            lastHeight = height;
+        }
+
+        target.draw(sprite);
+    }
+}
+
+#endif // LIFEGAME_RASTER_RENDERER_CPP
@@ -0,0 +1,38 @@
+#ifndef LIFEGAME_RENDERER_CPP
+#define LIFEGAME_RENDERER_CPP
+
+#include <stdexcept>
+#include "renderer.h"
+#include "incremental_renderer.h"
+#include "raster_renderer.h"
+#include "shape_renderer.h"
+#include "texture_renderer.h"
+#include "vertex_renderer.h"
+
+namespace lifegame {
+
+    using std::invalid_argument;
+
+    const vector<string> Renderer::types { "shape", "vertex", "texture", "incremental", "raster" };
+
+    Renderer* Renderer::create(const string& type) {
+        if(type == "shape")
+            return new ShapeRenderer();
+
+        if(type == "vertex")
+            return new VertexRenderer();
+
+        if(type == "texture")
+            return new TextureRenderer();
+
+        if(type == "incremental")
+            return new IncrementalRenderer();
+
+        if(type == "raster")
+            return new RasterRenderer();
+
+        throw invalid_argument("Unknown renderer type \"" + type + "\"");
+    }
+}
+
+#endif // LIFEGAME_RENDERER_CPP
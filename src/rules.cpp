@@ -1,12 +1,20 @@
 #ifndef LIFEGAME_RULES_CPP
 #define LIFEGAME_RULES_CPP
 
+#include <stdexcept>
+#include <cctype>
 #include "rules.h"
 
 namespace lifegame {
 
     Rules::Rules(Rule birth, Rule survive):
-            birth(birth), survive(survive), name(nameFor(birth, survive)) {}
+            birth(birth), survive(survive), name(nameFor(birth, survive)) {
+
+        for(int neighbours = 0; neighbours <= MAX_RULE_NUMS; ++neighbours) {
+            table[neighbours << 1 | CELL_OFF] = birth.matches(neighbours) ? CELL_ON : CELL_OFF;
+            table[neighbours << 1 | CELL_ON] = survive.matches(neighbours) ? CELL_ON : CELL_OFF;
+        }
+    }
 
 
     void Rules::writeName(string& name, Rule rule) {
@@ -28,6 +36,36 @@ namespace lifegame {
         return name;
     }
 
+    Rules Rules::parse(const string& str) {
+        rule_t birth = 0, survive = 0;
+        rule_t* current = nullptr;
+        bool birthFound = false, surviveFound = false;
+
+        for(char c : str) {
+            const char upper = toupper((unsigned char)c);
+
+            if(upper == 'B' && !birthFound) {
+                current = &birth;
+                birthFound = true;
+
+            } else if(upper == 'S' && !surviveFound) {
+                current = &survive;
+                surviveFound = true;
+
+            } else if(c >= '0' && c <= '0' + MAX_RULE_NUMS && current != nullptr) {
+                *current |= 1 << (c - '0');
+
+            } else if(c != '/' && c != ':' && c != ' ') {
+                throw std::invalid_argument("Invalid rules \"" + str + "\"");
+            }
+        }
+
+        if(!birthFound || !surviveFound)
+            throw std::invalid_argument("Invalid rules \"" + str + "\"");
+
+        return Rules(birth, survive);
+    }
+
     bool Rules::matches(Cell cell, int neighbours) const {
         return cell.isOn() ? !survive.matches(neighbours) : birth.matches(neighbours);
     }
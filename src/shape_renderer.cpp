@@ -0,0 +1,16 @@
+#ifndef LIFEGAME_SHAPE_RENDERER_CPP
+#define LIFEGAME_SHAPE_RENDERER_CPP
+
+#include "shape_renderer.h"
+#include "cell.h"
+
+namespace lifegame {
+
+    void ShapeRenderer::draw(RenderTarget& target, const Snapshot& snapshot, int width, int height) {
+        snapshot.forEachOn(0, 0, width, height, [&target] (int x, int y) {
+            Cell::drawCell(target, x, y);
+        });
+    }
+}
+
+#endif // LIFEGAME_SHAPE_RENDERER_CPP
@@ -0,0 +1,39 @@
+#ifndef LIFEGAME_SIMD_CPP
+#define LIFEGAME_SIMD_CPP
+
+#include <algorithm>
+#include "simd.h"
+
+namespace lifegame {
+
+    const char* const SIMD_LEVEL_NAMES[SIMD_LEVELS] = { "none", "sse2", "avx2", "avx512" };
+
+    SimdLevel detectSimdLevel() {
+        #if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+
+        if(__builtin_cpu_supports("avx512bw"))
+            return SIMD_AVX512;
+
+        if(__builtin_cpu_supports("avx2"))
+            return SIMD_AVX2;
+
+        if(__builtin_cpu_supports("sse2"))
+            return SIMD_SSE2;
+        #endif
+
+        return SIMD_NONE;
+    }
+
+    static SimdLevel simdLevel = detectSimdLevel();
+
+    SimdLevel getSimdLevel() {
+        return simdLevel;
+    }
+
+    void setSimdLevel(SimdLevel level) {
+        simdLevel = std::min(level, detectSimdLevel());
+    }
+}
+
+#endif // LIFEGAME_SIMD_CPP
@@ -0,0 +1,134 @@
+#ifndef LIFEGAME_SNAPSHOT_CPP
+#define LIFEGAME_SNAPSHOT_CPP
+
+#include <algorithm>
+#include "snapshot.h"
+
+namespace lifegame {
+
+    void Snapshot::capture(const Field& field, int startX, int startY, int endX, int endY) {
+        if(!field.isUnbounded()) {
+            endX = std::min(endX, field.getWidth());
+            endY = std::min(endY, field.getHeight());
+            startX = std::min(startX, endX);
+            startY = std::min(startY, endY);
+        }
+
+        width = endX - startX;
+        height = endY - startY;
+        blockSize = 0;
+        cells.assign((size_t)width * height, 0);
+        population = 0;
+
+        field.forEachOn(startX, startY, endX, endY, [this, startX, startY] (int x, int y) {
+            cells[(size_t)(x - startX) * height + (y - startY)] = 1;
+            ++population;
+        });
+    }
+
+    void Snapshot::forEachOn(int startX, int startY, int endX, int endY, function<void(int, int)> func) const {
+        if(blockSize != 0) // В уменьшенном снимке клеток нет
+            return;
+
+        endX = std::min(endX, width);
+        endY = std::min(endY, height);
+
+        for(int x = startX; x < endX; ++x) {
+            const char* const column = &cells[(size_t)x * height];
+
+            for(int y = startY; y < endY; ++y) {
+                if(column[y])
+                    func(x, y);
+            }
+        }
+    }
+
+    void Snapshot::forEachOn(function<void(int, int)> func) const {
+        forEachOn(0, 0, width, height, func);
+    }
+
+
+    uint64_t ChangeTracker::track(const vector<char>& cells, int width, int height, uint64_t serial, vector<int>& dirtyTiles) {
+        dirtyTiles.clear();
+
+        if(width != this->width || height != this->height) {
+            this->width = width;
+            this->height = height;
+            this->cells = cells;
+            this->serial = serial;
+
+            return 0;
+        }
+
+        const int
+                tilesWidth = (width + Snapshot::TILE_SIZE - 1) / Snapshot::TILE_SIZE,
+                tilesHeight = (height + Snapshot::TILE_SIZE - 1) / Snapshot::TILE_SIZE;
+
+        for(int tileX = 0; tileX < tilesWidth; ++tileX) {
+            const int startX = tileX * Snapshot::TILE_SIZE, endX = std::min(startX + Snapshot::TILE_SIZE, width);
+
+            for(int tileY = 0; tileY < tilesHeight; ++tileY) {
+                const int startY = tileY * Snapshot::TILE_SIZE, length = std::min(Snapshot::TILE_SIZE, height - startY);
+
+                bool changed = false;
+
+                for(int x = startX; x < endX && !changed; ++x) {
+                    const size_t offset = (size_t)x * height + startY;
+                    changed = !std::equal(&this->cells[offset], &this->cells[offset] + length, &cells[offset]);
+                }
+
+                if(!changed)
+                    continue;
+
+                for(int x = startX; x < endX; ++x) {
+                    const size_t offset = (size_t)x * height + startY;
+                    std::copy_n(&cells[offset], length, &this->cells[offset]);
+                }
+
+                dirtyTiles.push_back(tileX * tilesHeight + tileY);
+            }
+        }
+
+        const uint64_t previousSerial = this->serial;
+        this->serial = serial;
+        return previousSerial;
+    }
+
+    void ChangeTracker::track(Snapshot& snapshot, uint64_t acquiredSerial) {
+        const uint64_t publishedSerial = serial;
+
+        if(track(snapshot.cells, snapshot.width, snapshot.height, snapshot.serial, snapshot.dirtyTiles) == 0) {
+            // Снимки до этого несравнимы с ним, поэтому отсчёт начинается заново
+            pendingFlags.assign(snapshot.tilesWidth() * snapshot.tilesHeight(), false);
+            pendingTiles.clear();
+            baseSerial = snapshot.serial;
+            snapshot.dirtySince = 0;
+            return;
+        }
+
+        if(acquiredSerial == publishedSerial) {
+            // Читатель получил последний опубликованный снимок: накопленное ему уже не нужно
+            for(int tile : pendingTiles)
+                pendingFlags[tile] = false;
+
+            pendingTiles.clear();
+        }
+
+        // Плитки, изменившиеся со снимка acquiredSerial, есть среди изменившихся с более раннего baseSerial
+        if(acquiredSerial >= baseSerial)
+            baseSerial = acquiredSerial;
+
+        for(int tile : snapshot.dirtyTiles) {
+            if(!pendingFlags[tile]) {
+                pendingFlags[tile] = true;
+                pendingTiles.push_back(tile);
+            }
+        }
+
+        // Если у читателя снимок старше начала отсчёта, ему нужно перерисовать всё
+        snapshot.dirtySince = acquiredSerial >= baseSerial ? acquiredSerial : 0;
+        snapshot.dirtyTiles = pendingTiles;
+    }
+}
+
+#endif // LIFEGAME_SNAPSHOT_CPP
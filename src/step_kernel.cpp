@@ -0,0 +1,219 @@
+#ifndef LIFEGAME_STEP_KERNEL_CPP
+#define LIFEGAME_STEP_KERNEL_CPP
+
+#include <vector>
+#include "step_kernel.h"
+#include "column_counters.h"
+
+namespace lifegame {
+
+    using std::vector;
+
+    /** Правила, известные при компиляции: сравнения с константами векторизуются компилятором */
+    template<rule_t birth, rule_t survive>
+    struct StaticRules {
+        static inline char next(const Rules&, char cell, uint8_t neighbours) {
+            char born = 0, survived = 0;
+
+            for(int n = 0; n <= MAX_RULE_NUMS; ++n) {
+                if(birth & (1 << n))   born |= neighbours == n;
+                if(survive & (1 << n)) survived |= neighbours == n;
+            }
+
+            return (cell & survived) | (~cell & born & CELL_ON);
+        }
+    };
+
+    /** Правила, заданные во время выполнения: поиск по таблице Rules */
+    struct DynamicRules {
+        static inline char next(const Rules& rules, char cell, uint8_t neighbours) {
+            return rules.next(cell, neighbours).value;
+        }
+    };
+
+    /** Записывает следующее поколение столбца по числам соседей counts; возвращает ненулевое значение, если столбец изменился */
+    template<class RulesType>
+    __attribute__((always_inline))
+    static inline char stepColumn(const Rules& rules, const Cell* currRow, Cell* nextRow, const uint8_t* counts, int height) {
+        char changes = 0;
+
+        for(int y = 0; y < height; ++y) {
+            const char cell = currRow[y].value,
+                       next = RulesType::next(rules, cell, counts[y]);
+
+            nextRow[y].value = next;
+            changes |= cell ^ next;
+        }
+
+        return changes;
+    }
+
+    template<int neighbourhood, SimdLevel level, class RulesType>
+    static bool stepKernel(const CellGrid& data, CellGrid& nextData,
+                           int startX, int startY, int endX, int endY, const Rules& rules, const CheckZone&) {
+
+        uint8_t counts[MAX_KERNEL_HEIGHT];
+        char changes = 0;
+
+        const int height = endY - startY;
+
+        for(int x = startX; x < endX; ++x) {
+            countColumn<neighbourhood, level>(data[x - 1] + startY, data[x] + startY, data[x + 1] + startY, counts, height);
+            changes |= stepColumn<RulesType>(rules, data[x] + startY, nextData[x] + startY, counts, height);
+        }
+
+        return changes != 0;
+    }
+
+    #ifdef LIFEGAME_X86
+
+    // GCC не встраивает функцию с атрибутом target в функцию с другим набором инструкций,
+    // поэтому векторные ядра компилируются под набор своего подсчёта соседей и вызывают его напрямую
+
+    template<int neighbourhood, class RulesType>
+    __attribute__((target("sse2")))
+    static bool stepKernelSse2(const CellGrid& data, CellGrid& nextData,
+                               int startX, int startY, int endX, int endY, const Rules& rules, const CheckZone&) {
+
+        uint8_t counts[MAX_KERNEL_HEIGHT];
+        char changes = 0;
+
+        const int height = endY - startY;
+
+        for(int x = startX; x < endX; ++x) {
+            countColumnSse2<neighbourhood>(data[x - 1] + startY, data[x] + startY, data[x + 1] + startY, counts, height);
+            changes |= stepColumn<RulesType>(rules, data[x] + startY, nextData[x] + startY, counts, height);
+        }
+
+        return changes != 0;
+    }
+
+    template<int neighbourhood, class RulesType>
+    __attribute__((target("avx2")))
+    static bool stepKernelAvx2(const CellGrid& data, CellGrid& nextData,
+                               int startX, int startY, int endX, int endY, const Rules& rules, const CheckZone&) {
+
+        uint8_t counts[MAX_KERNEL_HEIGHT];
+        char changes = 0;
+
+        const int height = endY - startY;
+
+        for(int x = startX; x < endX; ++x) {
+            countColumnAvx2<neighbourhood>(data[x - 1] + startY, data[x] + startY, data[x + 1] + startY, counts, height);
+            changes |= stepColumn<RulesType>(rules, data[x] + startY, nextData[x] + startY, counts, height);
+        }
+
+        return changes != 0;
+    }
+
+    template<int neighbourhood, class RulesType>
+    __attribute__((target("avx512f,avx512bw")))
+    static bool stepKernelAvx512(const CellGrid& data, CellGrid& nextData,
+                                 int startX, int startY, int endX, int endY, const Rules& rules, const CheckZone&) {
+
+        uint8_t counts[MAX_KERNEL_HEIGHT];
+        char changes = 0;
+
+        const int height = endY - startY;
+
+        for(int x = startX; x < endX; ++x) {
+            countColumnAvx512<neighbourhood>(data[x - 1] + startY, data[x] + startY, data[x + 1] + startY, counts, height);
+            changes |= stepColumn<RulesType>(rules, data[x] + startY, nextData[x] + startY, counts, height);
+        }
+
+        return changes != 0;
+    }
+
+    #endif // LIFEGAME_X86
+
+    /** Для окрестностей, не известных при компиляции */
+    static bool genericStepKernel(const CellGrid& data, CellGrid& nextData,
+                                  int startX, int startY, int endX, int endY, const Rules& rules, const CheckZone& checkZone) {
+
+        uint8_t counts[MAX_KERNEL_HEIGHT];
+        char changes = 0;
+
+        const int height = endY - startY;
+
+        for(int x = startX; x < endX; ++x) {
+            Cell* const currRow = const_cast<Cell*>(data[x]) + startY;
+            Cell* const nextRow = nextData[x] + startY;
+
+            checkZone.countColumn(const_cast<Cell*>(data[x - 1]) + startY, currRow, const_cast<Cell*>(data[x + 1]) + startY, counts, height);
+
+            for(int y = 0; y < height; ++y) {
+                const Cell cell = currRow[y],
+                           next = rules.next(cell, counts[y]);
+
+                nextRow[y] = next;
+                changes |= cell.value ^ next.value;
+            }
+        }
+
+        return changes != 0;
+    }
+
+
+    struct KernelEntry {
+        int neighbourhood;
+        bool staticRules;
+        rule_t birth, survive;
+        StepKernel kernels[SIMD_LEVELS];
+    };
+
+    template<int neighbourhood, class RulesType>
+    static KernelEntry kernelEntry(bool staticRules, rule_t birth = 0, rule_t survive = 0) {
+        return {
+            neighbourhood, staticRules, birth, survive, {
+                #ifdef LIFEGAME_X86
+                stepKernel<neighbourhood, SIMD_NONE, RulesType>,
+                stepKernelSse2<neighbourhood, RulesType>,
+                stepKernelAvx2<neighbourhood, RulesType>,
+                stepKernelAvx512<neighbourhood, RulesType>
+                #else
+                stepKernel<neighbourhood, SIMD_NONE,   RulesType>,
+                stepKernel<neighbourhood, SIMD_SSE2,   RulesType>,
+                stepKernel<neighbourhood, SIMD_AVX2,   RulesType>,
+                stepKernel<neighbourhood, SIMD_AVX512, RulesType>
+                #endif // LIFEGAME_X86
+            }
+        };
+    }
+
+    template<int neighbourhood, rule_t birth, rule_t survive>
+    static KernelEntry staticKernelEntry() {
+        return kernelEntry<neighbourhood, StaticRules<birth, survive>>(true, birth, survive);
+    }
+
+    /** Ядра для каждой окрестности: с правилами из LifeGame::RULES и с произвольными правилами */
+    template<int neighbourhood>
+    static void addKernelEntries(vector<KernelEntry>& entries) {
+        entries.push_back(staticKernelEntry<neighbourhood, makeRule(3),          makeRule(2, 3)>());
+        entries.push_back(staticKernelEntry<neighbourhood, makeRule(5, 6, 7, 8), makeRule(0, 1, 2, 3, 4, 5, 6, 7, 8)>());
+        entries.push_back(staticKernelEntry<neighbourhood, makeRule(5, 6, 7, 8), makeRule(4, 5, 6, 7, 8)>());
+        entries.push_back(staticKernelEntry<neighbourhood, makeRule(1),          makeRule(0, 1, 2, 3, 4, 5, 6, 7, 8)>());
+        entries.push_back(kernelEntry<neighbourhood, DynamicRules>(false));
+    }
+
+    static vector<KernelEntry> createKernelRegistry() {
+        vector<KernelEntry> entries;
+        addKernelEntries<QuadCheckZone::NEIGHBOURHOOD>(entries);
+        addKernelEntries<RhombCheckZone::NEIGHBOURHOOD>(entries);
+        addKernelEntries<CrossCheckZone::NEIGHBOURHOOD>(entries);
+        return entries;
+    }
+
+    StepKernel stepKernelFor(const CheckZone& checkZone, const Rules& rules, SimdLevel level) {
+        static const vector<KernelEntry> registry = createKernelRegistry();
+
+        for(const KernelEntry& entry : registry) {
+            if(entry.neighbourhood == checkZone.neighbourhood &&
+                    (!entry.staticRules || (entry.birth == rules.birth.value && entry.survive == rules.survive.value)))
+                return entry.kernels[level];
+        }
+
+        return genericStepKernel;
+    }
+}
+
+#endif // LIFEGAME_STEP_KERNEL_CPP
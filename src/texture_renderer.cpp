@@ -0,0 +1,73 @@
+#ifndef LIFEGAME_TEXTURE_RENDERER_CPP
+#define LIFEGAME_TEXTURE_RENDERER_CPP
+
+#include <algorithm>
+#include "texture_renderer.h"
+#include "cell.h"
+
+namespace lifegame {
+
+    void TextureRenderer::createGap() {
+        // Последние строка и столбец клетки закрашены цветом фона, остальное прозрачно
+        Image gap;
+        gap.create(CELL_SIZE, CELL_SIZE, Color::Transparent);
+
+        for(int i = 0; i < CELL_SIZE; ++i) {
+            gap.setPixel(CELL_SIZE - 1, i, Color::Black);
+            gap.setPixel(i, CELL_SIZE - 1, Color::Black);
+        }
+
+        gapTexture.create(CELL_SIZE, CELL_SIZE);
+        gapTexture.update(gap);
+        gapTexture.setRepeated(true);
+        gapSprite.setTexture(gapTexture);
+    }
+
+    void TextureRenderer::upload(const Snapshot& snapshot, int width, int height) {
+        if(width != lastWidth || height != lastHeight) {
+            pixels.resize((size_t)width * height);
+            cellsTexture.create(width, height);
+            cellsSprite.setTexture(cellsTexture, true);
+        }
+
+        // Снимок хранится по столбцам, текстура - по строкам
+        for(int x = 0; x < width; ++x) {
+            const char* const column = &snapshot.cells[(size_t)x * snapshot.height];
+            Uint32* texel = &pixels[x];
+
+            for(int y = 0; y < height; ++y, texel += width) {
+                *texel = column[y] ? TEXEL_ON : TEXEL_OFF;
+            }
+        }
+
+        cellsTexture.update(reinterpret_cast<const Uint8*>(pixels.data()));
+    }
+
+    void TextureRenderer::draw(RenderTarget& target, const Snapshot& snapshot, int width, int height) {
+        width = std::min(width, snapshot.width);
+        height = std::min(height, snapshot.height);
+
+        if(width <= 0 || height <= 0)
+            return;
+
+        if(CELL_SIZE != lastCellSize)
+            createGap();
+
+        if(snapshot.serial != lastSerial || width != lastWidth || height != lastHeight)
+            upload(snapshot, width, height);
+
+        lastSerial = snapshot.serial;
+        lastCellSize = CELL_SIZE;
+        lastWidth = width;
+        lastHeight = height;
+
+        // Растягивание без сглаживания: каждый тексель становится квадратом CELL_SIZE x CELL_SIZE
+        cellsSprite.setScale(CELL_SIZE, CELL_SIZE);
+        gapSprite.setTextureRect(IntRect(0, 0, width * CELL_SIZE, height * CELL_SIZE));
+
+        target.draw(cellsSprite);
+        target.draw(gapSprite);
+    }
+}
+
+#endif // LIFEGAME_TEXTURE_RENDERER_CPP
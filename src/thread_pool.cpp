@@ -0,0 +1,105 @@
+#ifndef LIFEGAME_THREAD_POOL_CPP
+#define LIFEGAME_THREAD_POOL_CPP
+
+#include "thread_pool.h"
+#include "tracer.h"
+
+namespace lifegame {
+
+    using std::lock_guard;
+    using std::unique_lock;
+
+    ThreadPool::ThreadPool(unsigned threadsCount) {
+        if(threadsCount == 0)
+            threadsCount = thread::hardware_concurrency();
+
+        for(unsigned i = 1; i < threadsCount; ++i) {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+        }
+
+        startCondition.notify_all();
+
+        for(thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    unsigned ThreadPool::getThreadsCount() const {
+        return workers.size() + 1;
+    }
+
+    void ThreadPool::work() {
+        const function<void(int)>& task = *this->task;
+
+        for(int i; (i = nextTask.fetch_add(1, std::memory_order_relaxed)) < tasksCount; ) {
+            TRACE_SCOPE("task");
+            task(i);
+        }
+    }
+
+    void ThreadPool::workerLoop() {
+        uint64_t seenGeneration = 0;
+
+        #ifdef TRACE
+        Tracer::setThreadName("worker");
+        #endif // TRACE
+
+        while(true) {
+            {
+                unique_lock<mutex> lock(mtx);
+                startCondition.wait(lock, [this, seenGeneration] () { return stopping || generation != seenGeneration; });
+
+                if(stopping)
+                    return;
+
+                seenGeneration = generation;
+            }
+
+            work();
+
+            {
+                lock_guard<mutex> lock(mtx);
+
+                if(--activeWorkers == 0)
+                    doneCondition.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::run(int count, const function<void(int)>& task) {
+        if(workers.empty() || count <= 1) {
+            for(int i = 0; i < count; ++i) {
+                task(i);
+            }
+
+            return;
+        }
+
+        {
+            lock_guard<mutex> lock(mtx);
+            this->task = &task;
+            tasksCount = count;
+            nextTask = 0;
+            activeWorkers = workers.size();
+            ++generation;
+        }
+
+        startCondition.notify_all();
+
+        work();
+
+        // Барьер: следующий вызов run() начнётся только после завершения всех задач
+        TRACE_SCOPE("wait workers");
+        unique_lock<mutex> lock(mtx);
+        doneCondition.wait(lock, [this] () { return activeWorkers == 0; });
+    }
+}
+
+#endif // LIFEGAME_THREAD_POOL_CPP
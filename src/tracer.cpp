@@ -0,0 +1,114 @@
+#ifndef LIFEGAME_TRACER_CPP
+#define LIFEGAME_TRACER_CPP
+
+#include "tracer.h"
+
+#ifdef TRACE
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace lifegame {
+
+    using std::vector;
+    using std::mutex;
+    using std::lock_guard;
+
+    string Tracer::path = "trace.json";
+
+    mutex Tracer::buffersMutex;
+    vector<Tracer::ThreadBuffer*> Tracer::buffers;
+
+    static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    int64_t Tracer::now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    Tracer::ThreadBuffer& Tracer::threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+
+        if(buffer == nullptr) {
+            buffer = new ThreadBuffer();
+
+            lock_guard<mutex> lock(buffersMutex);
+            buffer->id = buffers.size() + 1;
+            buffers.push_back(buffer);
+        }
+
+        return *buffer;
+    }
+
+    void Tracer::setThreadName(const char* name) {
+        threadBuffer().name = name;
+    }
+
+    void Tracer::dump() {
+        std::ofstream out(path);
+
+        if(!out) {
+            std::cerr << "Cannot write trace to \"" << path << "\"" << std::endl;
+            return;
+        }
+
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+        struct CopiedEvent {
+            const char* name;
+            int64_t start, duration;
+        };
+
+        vector<CopiedEvent> events;
+        bool first = true;
+        lock_guard<mutex> lock(buffersMutex);
+
+        for(const ThreadBuffer* buffer : buffers) {
+            if(buffer->name != nullptr) {
+                out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id
+                    << ", \"args\": {\"name\": \"" << buffer->name << "\"}}";
+                first = false;
+            }
+
+            const uint64_t count = buffer->count.load(std::memory_order_acquire),
+                           begin = count > EVENTS_PER_THREAD ? count - EVENTS_PER_THREAD : 0;
+
+            events.clear();
+
+            for(uint64_t i = begin; i < count; ++i) {
+                const Event& event = buffer->events[i % EVENTS_PER_THREAD];
+
+                events.push_back({
+                        event.name.load(std::memory_order_relaxed),
+                        event.start.load(std::memory_order_relaxed),
+                        event.duration.load(std::memory_order_relaxed)
+                });
+            }
+
+            // Пока события копировались, поток мог начать записи с номерами до started - 1. Копии событий
+            // с номерами меньше started - EVENTS_PER_THREAD могут быть составлены из разных записей
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            const uint64_t started = buffer->started.load(std::memory_order_relaxed),
+                           valid = started > EVENTS_PER_THREAD ? started - EVENTS_PER_THREAD : 0;
+
+            for(uint64_t i = std::max(begin, valid); i < count; ++i) {
+                const CopiedEvent& event = events[i - begin];
+
+                // Время в микросекундах
+                out << (first ? "" : ",\n") << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id
+                    << ", \"ts\": " << event.start / 1000 << '.' << event.start / 100 % 10
+                    << ", \"dur\": " << event.duration / 1000 << '.' << event.duration / 100 % 10 << '}';
+                first = false;
+            }
+        }
+
+        out << "\n]}\n";
+
+        std::cout << "Trace written to \"" << path << "\"" << std::endl;
+    }
+}
+
+#endif // TRACE
+
+#endif // LIFEGAME_TRACER_CPP
@@ -0,0 +1,67 @@
+#ifndef LIFEGAME_VERTEX_RENDERER_CPP
+#define LIFEGAME_VERTEX_RENDERER_CPP
+
+#include <algorithm>
+#include "vertex_renderer.h"
+#include "cell.h"
+
+namespace lifegame {
+
+    void VertexRenderer::build(const Snapshot& snapshot, int width, int height) {
+        width = std::min(width, snapshot.width);
+        height = std::min(height, snapshot.height);
+
+        size_t count = 0;
+
+        for(int x = 0; x < width; ++x) {
+            const char* const column = &snapshot.cells[(size_t)x * snapshot.height];
+            count += std::count(column, column + height, 1);
+        }
+
+        // Цвет задаётся только новым вершинам, у остальных он уже белый
+        const size_t oldVertexCount = quads.getVertexCount();
+
+        if(count * 4 != oldVertexCount) {
+            quads.resize(count * 4);
+
+            for(size_t i = oldVertexCount; i < count * 4; ++i) {
+                quads[i].color = Color::White;
+            }
+        }
+
+        const float size = CELL_SIZE - 1;
+        Vertex* quad = count == 0 ? nullptr : &quads[0];
+
+        for(int x = 0; x < width; ++x) {
+            const char* const column = &snapshot.cells[(size_t)x * snapshot.height];
+            const float left = x * CELL_SIZE;
+
+            for(int y = 0; y < height; ++y) {
+                if(column[y]) {
+                    const float top = y * CELL_SIZE;
+
+                    quad[0].position = Vector2f(left,        top);
+                    quad[1].position = Vector2f(left + size, top);
+                    quad[2].position = Vector2f(left + size, top + size);
+                    quad[3].position = Vector2f(left,        top + size);
+                    quad += 4;
+                }
+            }
+        }
+    }
+
+    void VertexRenderer::draw(RenderTarget& target, const Snapshot& snapshot, int width, int height) {
+        if(snapshot.serial != lastSerial || CELL_SIZE != lastCellSize || width != lastWidth || height != lastHeight) {
+            build(snapshot, width, height);
+
+            lastSerial = snapshot.serial;
+            lastCellSize = CELL_SIZE;
+            lastWidth = width;
+            lastHeight = height;
+        }
+
+        target.draw(quads);
+    }
+}
+
+#endif // LIFEGAME_VERTEX_RENDERER_CPP